@@ -3,6 +3,7 @@ import websockets
 from websockets.asyncio.server import serve, ServerConnection
 import struct
 import time
+import zlib
 import math
 import json
 import numpy as np
@@ -40,6 +41,65 @@ MEL_TOP_DB = 80.0   # dB floor (librosa default: top_db=80 → range −80 to 0
 HEADER_FORMAT = "<IB3sII"
 FRAME_FORMAT = f"<Iff{SAMPLES_PER_FRAME}h{SAMPLES_PER_FRAME}h"
 
+# --- Protocol v2 (negotiated payload modes, see src/protocol_schema.h) ---
+BATCH_HEADER_V2_SIZE = 24
+FRAME_HEADER_V2_SIZE = 16
+# magic, ver, mode, frames, rate, seq, ts, payload_crc32, dropped, ext
+HEADER_V2_FORMAT = "<I4BIIIH2s"
+FRAME_HEADER_V2_FORMAT = "<IffBBH"  # frame_seq, vad, rms, channel, flags, gap
+
+PAYLOAD_FULL = 0x00
+PAYLOAD_CLEAN_ONLY = 0x01
+PAYLOAD_RAW_DELTA8 = 0x02
+PAYLOAD_SILENCE = 0x03  # Header-only marker for a VAD-suppressed batch
+PAYLOAD_RAW_PREVIEW8 = 0x04  # Full clean + 8x peak-decimated raw preview
+PAYLOAD_TELEMETRY = 0xF0
+PAYLOAD_CTRL_ACK = 0xF1  # 12-byte ack for a downlink control message
+
+PREVIEW_DECIM = 8  # Raw samples folded into each preview sample
+
+FRAME_FLAG_FILLER = 0x01  # Zero-PCM filler the ESP injected to close a gap
+
+# CtrlAckPacket: magic, ver, mode, opcode, status, value
+CTRL_ACK_FORMAT = "<I4BI"
+CTRL_OPCODE_NAMES = {
+    0x01: "SET_PAYLOAD_MODE",
+    0x02: "SET_BATCH_FRAMES",
+    0x03: "SET_SAMPLE_RATE",
+    0x04: "SET_VAD_GATE",
+    0x05: "SET_GATE_THRESH",
+    0x06: "SET_CLEAN_SCALE",
+    0x07: "SET_PROCESSOR",
+}
+
+# TelemetryPacket: magic, ver, mode, stage_count, reserved, uptime,
+# 7 counters, heap free/largest/min-free, 3 per-task stack low-waters,
+# then 4 stages x (samples, min, max, p50, p99) cycles
+TELEMETRY_FORMAT = "<I4B34I"
+TELEMETRY_STAGES = ["i2s_read", "inference", "frame", "ws_send"]
+CYCLES_PER_US = 240  # ESP32-S3 @ 240 MHz
+
+# Raw reconstruction for RAW_DELTA8: raw ~= clean * 5/4 + (delta << 2)
+RAW_PRED_NUM = 5
+RAW_PRED_DEN = 4
+RAW_DELTA_SHIFT = 2
+
+# Negotiated capture rate (v2 header sample_rate_code); the 16 kHz mode
+# keeps the 10 ms frame cadence but each frame carries 160 samples
+RATE_48K = 0x00
+RATE_16K = 0x01
+RATE_SAMPLES_PER_FRAME = {RATE_48K: 480, RATE_16K: 160}
+
+
+def v2_payload_size(payload_mode: int, samples: int):
+    """Per-frame payload size (bytes) for a mode at a given frame length."""
+    return {
+        PAYLOAD_FULL: 2 * 2 * samples,
+        PAYLOAD_CLEAN_ONLY: 2 * samples,
+        PAYLOAD_RAW_DELTA8: 2 * samples + samples,
+        PAYLOAD_RAW_PREVIEW8: 2 * samples + 2 * (samples // PREVIEW_DECIM),
+    }.get(payload_mode)
+
 
 @dataclass
 class AudioFrame:
@@ -48,6 +108,7 @@ class AudioFrame:
     rms_raw: float
     raw_pcm: List[int]
     clean_pcm: List[int]
+    channel: int = 0  # Capture channel id (dual-mic units send 0 and 1)
 
 
 # ============================================================================
@@ -596,6 +657,11 @@ class ESP32Handler:
         self.voice_logger = VoiceActivityLogger()
         self.last_batch_seq: Optional[int] = None
         self.packet_loss_count = 0
+        self.silence_count = 0  # VAD-suppressed batches (silence markers)
+        self.esp_dropped_count = 0  # Frames lost on the ESP (header field)
+        self.crc_error_count = 0  # Batches discarded on payload CRC mismatch
+        self.seq_gap_frames = 0  # Frames the ESP reported missing (gap field)
+        self.filler_frames = 0  # Zero-fill frames injected by the ESP
 
     async def handle(self, websocket: ServerConnection):
         client_addr = websocket.remote_address
@@ -610,23 +676,229 @@ class ESP32Handler:
         except Exception as e:
             logger.error(f"Error handling ESP32: {e}", exc_info=True)
 
+    def _parse_v1(self, message: bytes):
+        """Parse a legacy v1 packet (fixed 7744 bytes, raw+clean always)."""
+        if len(message) != EXPECTED_PACKET_SIZE:
+            logger.warning(f"Invalid v1 packet size: {len(message)}")
+            return None
+
+        _, _, _, batch_seq, timestamp_ms = struct.unpack(
+            HEADER_FORMAT, message[:BATCH_HEADER_SIZE])
+
+        frames: List[AudioFrame] = []
+        for i in range(FRAMES_PER_BATCH):
+            offset = BATCH_HEADER_SIZE + (AUDIO_FRAME_SIZE * i)
+            frame_data = message[offset:offset + AUDIO_FRAME_SIZE]
+            try:
+                unpacked = struct.unpack(FRAME_FORMAT, frame_data)
+            except struct.error as e:
+                logger.error(f"Frame parse error: {e}")
+                return None
+            frame_seq, vad_prob, rms_raw = unpacked[0], unpacked[1], unpacked[2]
+            raw_start = 3
+            clean_start = 3 + SAMPLES_PER_FRAME
+            raw_pcm = list(unpacked[raw_start:raw_start + SAMPLES_PER_FRAME])
+            clean_pcm = list(unpacked[clean_start:clean_start + SAMPLES_PER_FRAME])
+            frames.append(AudioFrame(frame_seq, vad_prob, rms_raw, raw_pcm, clean_pcm))
+
+        return batch_seq, timestamp_ms, frames
+
+    def _parse_v2(self, message: bytes):
+        """Parse a v2 packet with a negotiated payload mode."""
+        if len(message) < BATCH_HEADER_V2_SIZE:
+            logger.warning(f"Short v2 packet: {len(message)}")
+            return None
+
+        (_, _, payload_mode, frames_per_batch, rate_code,
+         batch_seq, timestamp_ms, payload_crc32, dropped_since_last,
+         _ext) = struct.unpack(
+            HEADER_V2_FORMAT, message[:BATCH_HEADER_V2_SIZE])
+
+        if dropped_since_last:
+            # ESP-side losses (queue overruns), as opposed to network gaps
+            # detected via batch_seq.
+            self.esp_dropped_count += dropped_since_last
+            logger.warning(
+                f"ESP dropped {dropped_since_last} frame(s) before batch "
+                f"{batch_seq} (total {self.esp_dropped_count})")
+
+        if payload_crc32 != 0:
+            computed = zlib.crc32(message[BATCH_HEADER_V2_SIZE:]) & 0xFFFFFFFF
+            if computed != payload_crc32:
+                self.crc_error_count += 1
+                logger.warning(
+                    f"CRC mismatch on batch {batch_seq}: "
+                    f"{computed:#010x} != {payload_crc32:#010x} "
+                    f"(total {self.crc_error_count}) -- discarding")
+                return None
+
+        samples = RATE_SAMPLES_PER_FRAME.get(rate_code)
+        if samples is None:
+            logger.warning(f"Unknown v2 rate code: {rate_code}")
+            return None
+
+        if payload_mode == PAYLOAD_SILENCE:
+            # Header-only marker: the ESP suppressed an all-silent batch.
+            # The empty frame list keeps sequence accounting intact while
+            # skipping all DSP/visualization work -- no audio is synthesized.
+            if len(message) != BATCH_HEADER_V2_SIZE:
+                logger.warning(f"Bad silence marker size: {len(message)}")
+                return None
+            self.silence_count += 1
+            if self.silence_count % 100 == 1:
+                logger.info(f"VAD gate active: {self.silence_count} batches "
+                            f"suppressed so far")
+            return batch_seq, timestamp_ms, []
+
+        payload_size = v2_payload_size(payload_mode, samples)
+        if payload_size is None:
+            logger.warning(f"Unknown v2 payload mode: {payload_mode}")
+            return None
+
+        expected = BATCH_HEADER_V2_SIZE + frames_per_batch * (
+            FRAME_HEADER_V2_SIZE + payload_size)
+        if len(message) != expected:
+            logger.warning(
+                f"Bad v2 packet size: {len(message)} (expected {expected}, "
+                f"mode={payload_mode}, frames={frames_per_batch}, "
+                f"rate={rate_code})")
+            return None
+
+        frames: List[AudioFrame] = []
+        offset = BATCH_HEADER_V2_SIZE
+        for _ in range(frames_per_batch):
+            (frame_seq, vad_prob, rms_raw, channel, flags,
+             gap) = struct.unpack_from(FRAME_HEADER_V2_FORMAT, message, offset)
+            offset += FRAME_HEADER_V2_SIZE
+
+            # Explicit continuity accounting from the ESP's pipeline: gap
+            # is how many frames of this channel's stream never made it
+            # (or were zero-filled -- those arrive flagged instead).
+            if gap:
+                self.seq_gap_frames += gap
+                logger.warning(
+                    f"Sequence gap: {gap} frame(s) missing before "
+                    f"frame {frame_seq} ch{channel} "
+                    f"(total {self.seq_gap_frames})")
+            if flags & FRAME_FLAG_FILLER:
+                self.filler_frames += 1
+
+            if payload_mode == PAYLOAD_FULL:
+                raw_pcm = list(np.frombuffer(
+                    message, dtype='<i2', count=samples, offset=offset))
+                offset += 2 * samples
+                clean_pcm = list(np.frombuffer(
+                    message, dtype='<i2', count=samples, offset=offset))
+                offset += 2 * samples
+            elif payload_mode == PAYLOAD_CLEAN_ONLY:
+                clean_pcm = list(np.frombuffer(
+                    message, dtype='<i2', count=samples, offset=offset))
+                offset += 2 * samples
+                # No raw stream in this mode -- mirror clean so downstream
+                # DSP/visualization keeps working (SNR will read as ~60 dB).
+                raw_pcm = list(clean_pcm)
+            elif payload_mode == PAYLOAD_RAW_PREVIEW8:
+                clean_pcm = list(np.frombuffer(
+                    message, dtype='<i2', count=samples, offset=offset))
+                offset += 2 * samples
+                preview = np.frombuffer(
+                    message, dtype='<i2', count=samples // PREVIEW_DECIM,
+                    offset=offset)
+                offset += 2 * (samples // PREVIEW_DECIM)
+                # Expand the peak-decimated preview back to frame length so
+                # downstream DSP/visualization sees uniform sample counts;
+                # each peak holds for its 8-sample group (envelope-exact for
+                # waveform plots, NOT faithful audio -- that's FULL's job).
+                raw_pcm = list(np.repeat(preview, PREVIEW_DECIM))
+            else:  # PAYLOAD_RAW_DELTA8
+                clean = np.frombuffer(
+                    message, dtype='<i2', count=samples, offset=offset
+                ).astype(np.int32)
+                offset += 2 * samples
+                delta = np.frombuffer(
+                    message, dtype=np.int8, count=samples, offset=offset
+                ).astype(np.int32)
+                offset += samples
+                raw = (clean * RAW_PRED_NUM) // RAW_PRED_DEN + (
+                    delta << RAW_DELTA_SHIFT)
+                raw = np.clip(raw, -32768, 32767).astype(np.int16)
+                raw_pcm = list(raw)
+                clean_pcm = list(clean.astype(np.int16))
+
+            frames.append(AudioFrame(frame_seq, vad_prob, rms_raw, raw_pcm,
+                                     clean_pcm, channel))
+
+        return batch_seq, timestamp_ms, frames
+
+    def _log_telemetry(self, message: bytes):
+        """Decode and log an ESP-side telemetry snapshot (stage histograms)."""
+        expected = struct.calcsize(TELEMETRY_FORMAT)
+        if len(message) != expected:
+            logger.warning(f"Bad telemetry size: {len(message)} != {expected}")
+            return
+        fields = struct.unpack(TELEMETRY_FORMAT, message)
+        uptime_ms = fields[5]
+        (captured, processed, sent, dropped, overruns, dma_ovf,
+         ring_hw) = fields[6:13]
+        heap_free, heap_largest, heap_min = fields[13:16]
+        stack_mic, stack_proc, stack_send = fields[16:19]
+        logger.info(
+            f"ESP telemetry @ {uptime_ms/1000:.0f}s: captured={captured} "
+            f"processed={processed} sent={sent} dropped={dropped} "
+            f"overruns={overruns} dma_ovf={dma_ovf} ring_hw={ring_hw}")
+        logger.info(
+            f"  mem: heap={heap_free}B (largest={heap_largest}, min={heap_min}) "
+            f"stack free: mic={stack_mic} proc={stack_proc} send={stack_send}")
+        for i, name in enumerate(TELEMETRY_STAGES):
+            samples, min_c, max_c, p50_c, p99_c = fields[19 + 5 * i:24 + 5 * i]
+            if samples == 0:
+                continue
+            logger.info(
+                f"  {name:<9} p50={p50_c / CYCLES_PER_US:7.0f}us "
+                f"p99={p99_c / CYCLES_PER_US:7.0f}us "
+                f"max={max_c / CYCLES_PER_US:7.0f}us n={samples}")
+
+    def _log_ctrl_ack(self, message: bytes):
+        """Decode and log the ESP's acknowledgement of a control message."""
+        expected = struct.calcsize(CTRL_ACK_FORMAT)
+        if len(message) != expected:
+            logger.warning(f"Bad ctrl ack size: {len(message)} != {expected}")
+            return
+        _, _, _, opcode, status, value = struct.unpack(CTRL_ACK_FORMAT, message)
+        name = CTRL_OPCODE_NAMES.get(opcode, f"0x{opcode:02x}")
+        outcome = "applied" if status == 1 else "REJECTED"
+        logger.info(f"ESP ctrl ack: {name} {outcome} (value=0x{value:x})")
+
     async def _process_binary_message(self, message: bytes):
         start_proc = time.perf_counter()
 
-        if not isinstance(message, bytes) or len(message) != EXPECTED_PACKET_SIZE:
-            logger.warning(f"Invalid packet size: {len(message) if isinstance(message, bytes) else type(message)}")
+        if not isinstance(message, bytes) or len(message) < 5:
+            logger.warning(f"Invalid packet: {type(message)}")
             return
 
-        # Parse header
-        header_data = message[:BATCH_HEADER_SIZE]
-        magic, version, reserved, batch_seq, timestamp_ms = struct.unpack(HEADER_FORMAT, header_data)
-
+        magic, version = struct.unpack_from("<IB", message)
         if magic != MAGIC_NUMBER:
             logger.warning(f"Invalid magic: {hex(magic)}")
             return
-        if version != 0x01:
+
+        if version == 0x02 and len(message) >= 6 and message[5] == PAYLOAD_TELEMETRY:
+            self._log_telemetry(message)
+            return
+
+        if version == 0x02 and len(message) >= 6 and message[5] == PAYLOAD_CTRL_ACK:
+            self._log_ctrl_ack(message)
+            return
+
+        if version == 0x01:
+            parsed = self._parse_v1(message)
+        elif version == 0x02:
+            parsed = self._parse_v2(message)
+        else:
             logger.warning(f"Unknown version: {version}")
             return
+        if parsed is None:
+            return
+        batch_seq, timestamp_ms, frames = parsed
 
         # Packet loss detection
         packet_loss = 0
@@ -642,28 +914,16 @@ class ESP32Handler:
         # Design Doc v1.2: Don't trust timestamp diff due to no NTP sync
         latency_ms = 63  # Budget: 40 + 3 + 5 + 10 + 5
 
-        # Parse frames
-        frames: List[AudioFrame] = []
-        for i in range(FRAMES_PER_BATCH):
-            offset = BATCH_HEADER_SIZE + (AUDIO_FRAME_SIZE * i)
-            frame_data = message[offset:offset + AUDIO_FRAME_SIZE]
-            try:
-                unpacked = struct.unpack(FRAME_FORMAT, frame_data)
-                frame_seq = unpacked[0]
-                vad_prob = unpacked[1]
-                rms_raw = unpacked[2]
-                raw_start = 3
-                clean_start = 3 + SAMPLES_PER_FRAME
-                raw_pcm = list(unpacked[raw_start:raw_start + SAMPLES_PER_FRAME])
-                clean_pcm = list(unpacked[clean_start:clean_start + SAMPLES_PER_FRAME])
-                frames.append(AudioFrame(frame_seq, vad_prob, rms_raw, raw_pcm, clean_pcm))
-            except struct.error as e:
-                logger.error(f"Frame parse error: {e}")
-                return
-
         if not frames:
             return
 
+        # Dual-mic batches interleave channel streams; visualization and
+        # DSP follow channel 0, the full frame list (with channel ids)
+        # stays available for beamforming experiments.
+        ch0 = [f for f in frames if f.channel == 0]
+        if ch0:
+            frames = ch0
+
         # Aggregate data from all 4 frames (40ms window)
         last_frame = frames[-1]
         all_raw, all_clean = [], []
@@ -0,0 +1,154 @@
+/**
+ * @file arena_pool.h
+ * @brief Pool allocator for processor tensor arenas (internal RAM first,
+ *        PSRAM overflow).
+ *
+ * Model processors used to plan for `static uint8_t arena[96*1024]` -- one
+ * arena baked into one class, which makes A/B-ing two model sizes in the
+ * field impossible without a rebuild.  The pool instead owns a single
+ * reserved internal-RAM region that processors carve arenas out of in
+ * init() and hand back in deinit().  When a request doesn't fit internal
+ * RAM (or two models are alive at once during a hot swap), the pool
+ * overflows into PSRAM -- slower, but a model that runs from PSRAM beats
+ * a model that doesn't load.
+ *
+ * ALLOCATION: first-fit over the internal region with 16-byte alignment
+ * (TFLite-micro's arena requirement).  At most MAX_ARENAS live arenas --
+ * in practice two: the active model plus the incoming one mid-swap.
+ *
+ * CONCURRENCY: acquire()/release() run from processor init()/deinit()
+ * only, which the pipeline confines to the control task (setup()/loop(),
+ * see AudioPipeline::swapProcessor()).  Single-owner by design, no locks.
+ */
+
+#ifndef ARENA_POOL_H
+#define ARENA_POOL_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+class ArenaPool {
+public:
+    static constexpr size_t INTERNAL_BYTES = 96 * 1024;
+    static constexpr int    MAX_ARENAS     = 4;
+
+    /**
+     * @brief Carve an arena out of the pool.
+     *
+     * @param bytes  Requested arena size (rounded up to 16-byte alignment).
+     * @return       16-byte-aligned pointer, or nullptr when neither the
+     *               internal region nor PSRAM can satisfy the request.
+     */
+    void* acquire(size_t bytes) {
+        bytes = (bytes + 15) & ~static_cast<size_t>(15);
+
+        Slot* slot = freeSlot();
+        if (slot == nullptr) {
+            Serial.printf("[Arena] All %d arena slots in use\n", MAX_ARENAS);
+            return nullptr;
+        }
+
+        // Internal region first: first-fit over the gaps between live
+        // internal arenas (slot count is tiny, the scan is trivial).
+        size_t off = internalFit(bytes);
+        if (off != NO_FIT) {
+            slot->ptr    = region_ + off;
+            slot->offset = off;
+            slot->size   = bytes;
+            slot->psram  = false;
+            slot->used   = true;
+            Serial.printf("[Arena] %u KB from internal region (offset %u)\n",
+                          static_cast<unsigned>(bytes / 1024),
+                          static_cast<unsigned>(off));
+            return slot->ptr;
+        }
+
+        // Overflow to PSRAM.  MALLOC_CAP_SPIRAM allocations are already
+        // 16-byte aligned on the S3.
+        uint8_t* p = static_cast<uint8_t*>(
+            heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM));
+        if (p == nullptr) {
+            Serial.printf("[Arena] %u KB arena failed (internal full, no PSRAM)\n",
+                          static_cast<unsigned>(bytes / 1024));
+            return nullptr;
+        }
+        slot->ptr    = p;
+        slot->offset = 0;
+        slot->size   = bytes;
+        slot->psram  = true;
+        slot->used   = true;
+        Serial.printf("[Arena] %u KB from PSRAM overflow\n",
+                      static_cast<unsigned>(bytes / 1024));
+        return p;
+    }
+
+    /** @brief Return an arena to the pool.  Ignores nullptr. */
+    void release(void* ptr) {
+        if (ptr == nullptr) return;
+        for (int i = 0; i < MAX_ARENAS; i++) {
+            if (slots_[i].used && slots_[i].ptr == ptr) {
+                if (slots_[i].psram) heap_caps_free(slots_[i].ptr);
+                slots_[i].used = false;
+                slots_[i].ptr  = nullptr;
+                return;
+            }
+        }
+        Serial.println("[Arena] release() of unknown pointer ignored");
+    }
+
+    /** @brief Largest internal-region arena currently acquirable. */
+    size_t internalLargestFree() const {
+        size_t best = 0;
+        for (size_t probe = INTERNAL_BYTES; probe >= 16; probe -= 16) {
+            if (internalFit(probe) != NO_FIT) { best = probe; break; }
+        }
+        return best;
+    }
+
+private:
+    static constexpr size_t NO_FIT = static_cast<size_t>(-1);
+
+    struct Slot {
+        uint8_t* ptr    = nullptr;
+        size_t   offset = 0;       ///< Within region_ (internal slots only)
+        size_t   size   = 0;
+        bool     psram  = false;
+        bool     used   = false;
+    };
+
+    Slot* freeSlot() {
+        for (int i = 0; i < MAX_ARENAS; i++) {
+            if (!slots_[i].used) return &slots_[i];
+        }
+        return nullptr;
+    }
+
+    /** @brief First-fit offset in the internal region, or NO_FIT. */
+    size_t internalFit(size_t bytes) const {
+        size_t off = 0;
+        // Walk candidate offsets; on collision with a live internal arena,
+        // jump past it and rescan.  Terminates in <= MAX_ARENAS passes.
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            if (off + bytes > INTERNAL_BYTES) return NO_FIT;
+            for (int i = 0; i < MAX_ARENAS; i++) {
+                const Slot& s = slots_[i];
+                if (!s.used || s.psram) continue;
+                if (off < s.offset + s.size && s.offset < off + bytes) {
+                    off   = s.offset + s.size;
+                    moved = true;
+                }
+            }
+        }
+        return off;
+    }
+
+    alignas(16) uint8_t region_[INTERNAL_BYTES];   ///< Reserved at link time
+    Slot slots_[MAX_ARENAS];
+};
+
+// Defined in main.cpp, shared by all processors.
+extern ArenaPool g_arenaPool;
+
+#endif // ARENA_POOL_H
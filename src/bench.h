@@ -0,0 +1,148 @@
+/**
+ * @file bench.h
+ * @brief On-device micro-benchmark harness for kernels and pipeline stages.
+ *
+ * Every kernel change so far (Q15 scaling, fused conversion/energy, the
+ * decimator) was justified with numbers measured off-target or estimated
+ * from instruction counts.  This harness closes that gap: it runs a table
+ * of benchmark cases over synthetic PCM for a few thousand iterations ON
+ * THE REAL SILICON and prints cycles/frame, cycles/sample, and headroom
+ * against the 10 ms frame budget.
+ *
+ * Each case runs once per core -- Core 0 and Core 1 share flash cache but
+ * not I-cache pressure, and the difference occasionally matters (a kernel
+ * that fits Core 1's budget can miss it on Core 0 next to the capture
+ * task's working set).
+ *
+ * Intended to run from setup() BEFORE the RTOS tasks and WiFi start, so
+ * nothing preempts the measurement (see runBenchSuite() in main.cpp).
+ * Not compiled into the hot path -- everything here is setup-time only.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+#include "telemetry.h"   // telemetryCycles(), TELEMETRY_CYCLES_PER_US
+
+/// Cycle budget for one 10 ms frame at the production clock.
+static constexpr uint32_t BENCH_FRAME_BUDGET_CYC = 10000 * TELEMETRY_CYCLES_PER_US;
+
+/// Default iteration count: long enough to average out cache warmup and
+/// timer interrupts, short enough that the full suite stays under a second.
+static constexpr int BENCH_DEFAULT_ITERS = 2000;
+
+/**
+ * @brief One benchmark case: a captureless callable over prepared buffers.
+ *
+ * The function must consume `ctx` (pointing at its input/output buffers)
+ * and feed any computed result into benchSink() so the optimizer cannot
+ * delete the work under test.
+ */
+struct BenchCase {
+    const char* name;             ///< Printed label, <= 20 chars
+    void (*fn)(void* ctx);        ///< One iteration of the kernel
+    void*       ctx;              ///< Kernel buffers / state
+    int         samplesPerIter;   ///< For the cycles/sample column
+};
+
+/// Optimizer barrier: results funneled here cannot be dead-code-eliminated.
+static volatile uint32_t g_benchSink = 0;
+static inline void benchSink(uint32_t v) { g_benchSink += v; }
+
+/**
+ * @brief Fill a PCM buffer with deterministic pseudo-random samples.
+ *
+ * LCG noise, same sequence every boot -- benchmark runs stay comparable
+ * across firmware versions.  Full int16 range so saturation paths in the
+ * kernels get exercised.
+ */
+static inline void benchFillPcm(int16_t* dst, int n, uint32_t seed) {
+    uint32_t s = seed * 2654435761u + 1;
+    for (int i = 0; i < n; i++) {
+        s = s * 1664525u + 1013904223u;
+        dst[i] = static_cast<int16_t>(s >> 16);
+    }
+}
+
+/** @brief 32-bit variant for the I2S conversion kernels (24-bit-in-high). */
+static inline void benchFillPcm32(int32_t* dst, int n, uint32_t seed) {
+    uint32_t s = seed * 2654435761u + 1;
+    for (int i = 0; i < n; i++) {
+        s = s * 1664525u + 1013904223u;
+        dst[i] = static_cast<int32_t>(s) & 0xFFFFFF00;
+    }
+}
+
+namespace bench_detail {
+
+struct RunArgs {
+    const BenchCase* cases;
+    int              caseCount;
+    int              iters;
+    volatile bool    done;
+};
+
+/** @brief Task body: time every case on the core this task is pinned to. */
+inline void runTask(void* pv) {
+    RunArgs* args = static_cast<RunArgs*>(pv);
+    const int core = xPortGetCoreID();
+
+    for (int c = 0; c < args->caseCount; c++) {
+        const BenchCase& bc = args->cases[c];
+
+        // Warm caches and branch predictors outside the timed region.
+        for (int i = 0; i < 16; i++) bc.fn(bc.ctx);
+
+        const uint32_t t0 = telemetryCycles();
+        for (int i = 0; i < args->iters; i++) bc.fn(bc.ctx);
+        const uint32_t total = telemetryCycles() - t0;
+
+        const uint32_t perIter = total / args->iters;
+        // cycles/sample in hundredths so sub-cycle kernels stay readable
+        const uint32_t perSample100 =
+            (bc.samplesPerIter > 0)
+                ? (100u * perIter) / bc.samplesPerIter : 0;
+        // headroom: per-iteration cost as a permille of the 10 ms budget
+        const uint32_t budgetPm =
+            static_cast<uint32_t>((1000ull * perIter) / BENCH_FRAME_BUDGET_CYC);
+
+        Serial.printf("[Bench] core%d  %-20s %8lu cyc/frame  "
+                      "%3lu.%02lu cyc/sample  %2lu.%lu%% of budget\n",
+                      core, bc.name,
+                      static_cast<unsigned long>(perIter),
+                      static_cast<unsigned long>(perSample100 / 100),
+                      static_cast<unsigned long>(perSample100 % 100),
+                      static_cast<unsigned long>(budgetPm / 10),
+                      static_cast<unsigned long>(budgetPm % 10));
+    }
+
+    args->done = true;
+    vTaskDelete(nullptr);
+}
+
+} // namespace bench_detail
+
+/**
+ * @brief Run all cases on both cores, printing one line per case per core.
+ *
+ * Spawns a temporary pinned task per core (sequentially -- the suite
+ * never self-interferes) and blocks until both finish.  Call from setup()
+ * only, before the audio tasks exist.
+ */
+static void benchRun(const BenchCase* cases, int caseCount,
+                     int iters = BENCH_DEFAULT_ITERS) {
+    Serial.printf("[Bench] %d cases x %d iters, budget = %lu cyc (10 ms)\n",
+                  caseCount, iters,
+                  static_cast<unsigned long>(BENCH_FRAME_BUDGET_CYC));
+
+    for (BaseType_t core = 0; core <= 1; core++) {
+        bench_detail::RunArgs args = { cases, caseCount, iters, false };
+        xTaskCreatePinnedToCore(bench_detail::runTask, "Bench", 4096,
+                                &args, 5, nullptr, core);
+        while (!args.done) delay(10);
+    }
+    Serial.println("[Bench] done");
+}
+
+#endif // BENCH_H
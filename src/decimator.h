@@ -0,0 +1,108 @@
+/**
+ * @file decimator.h
+ * @brief 3:1 polyphase FIR decimator for the optional 16 kHz capture mode.
+ *
+ * VAD-only deployments don't need full-band audio: decimating 48 kHz
+ * capture to 16 kHz before inference cuts model input, RMS work, and wire
+ * bandwidth by 3x.  The I2S clocking stays at 48 kHz (the INMP441
+ * BCLK = 64 x WS requirement is untouched); this stage sits between the
+ * capture ring and AudioPipeline inference, so one 480-sample input frame
+ * becomes one 160-sample frame at the same 10 ms cadence.
+ *
+ * FILTER: 48-tap Hamming-windowed sinc, cutoff 6.8 kHz, Q15 coefficients
+ * with exact unity DC gain (sum = 32768).  Response: flat to 4.8 kHz,
+ * -27 dB at the new Nyquist (8 kHz), below -57 dB past 9.6 kHz -- aliasing
+ * lands under the noise floor of the mic itself.
+ *
+ * INNER LOOP: fixed-point MAC, 4x unrolled, same register as the kernels
+ * in dsp_kernels.h.  It stays scalar on purpose: 48 taps x 160 outputs is
+ * ~7.7k MACs = ~40 us/frame at 240 MHz, and ESP-DSP's dsps_fird_s16 wants
+ * its coefficients pre-reversed and shift-quantizes the accumulator --
+ * the same low-bit loss that kept dsps_dotprod_s16 out of dsp_sumsq_s16.
+ * Revisit only if a profile ever shows this stage above 1% of the frame
+ * budget.
+ *
+ * CONCURRENCY: one instance, owned by AudioPipeline, touched only by the
+ * processing task.  The 47-sample history carries filter state across
+ * frames; call reset() when enabling the stage so stale history from a
+ * previous session cannot leak in.
+ */
+
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <stdint.h>
+#include <string.h>
+
+class Decimator3x {
+public:
+    static constexpr int FACTOR = 3;
+    static constexpr int TAPS   = 48;
+
+    /** @brief Clear filter history.  Call when (re)entering 16 kHz mode. */
+    void reset() { memset(hist_, 0, sizeof(hist_)); }
+
+    /**
+     * @brief Decimate `n` input samples to `n / FACTOR` output samples.
+     *
+     * @param dst  Destination buffer, at least n / FACTOR samples.
+     * @param src  Source PCM at 48 kHz, `n` samples (n % FACTOR == 0,
+     *             n <= MAX_INPUT).
+     * @param n    Input sample count.
+     * @return     Output sample count (n / FACTOR).
+     */
+    int process(int16_t* dst, const int16_t* src, int n) {
+        if (n > MAX_INPUT) n = MAX_INPUT;
+
+        // Contiguous work view: [47 history samples | n new samples], so the
+        // inner loop needs no wrap logic.  The filter is symmetric, which
+        // lets the convolution read work[] forward with the coefficients in
+        // natural order.
+        memcpy(work_, hist_, sizeof(hist_));
+        memcpy(work_ + TAPS - 1, src, n * sizeof(int16_t));
+
+        const int nOut = n / FACTOR;
+        for (int k = 0; k < nOut; k++) {
+            const int16_t* x = &work_[k * FACTOR];
+            int32_t acc = 0;
+            // Worst case |acc| = 32768 * sum|coeff| = 1.74e9 < 2^31.
+            for (int j = 0; j + 4 <= TAPS; j += 4) {
+                acc += x[j + 0] * COEFFS_Q15[j + 0];
+                acc += x[j + 1] * COEFFS_Q15[j + 1];
+                acc += x[j + 2] * COEFFS_Q15[j + 2];
+                acc += x[j + 3] * COEFFS_Q15[j + 3];
+            }
+            acc >>= 15;
+            if (acc >  32767) acc =  32767;   // Passband ripple can overshoot
+            if (acc < -32768) acc = -32768;
+            dst[k] = static_cast<int16_t>(acc);
+        }
+
+        memcpy(hist_, src + n - (TAPS - 1), sizeof(hist_));
+        return nOut;
+    }
+
+private:
+    static constexpr int MAX_INPUT = 480;   // One FRAME_SIZE frame per call
+
+    // Hamming-windowed sinc, fc = 6.8 kHz @ 48 kHz, Q15, DC gain exactly 1.0
+    static constexpr int16_t COEFFS_Q15[TAPS] = {
+            31,     36,     13,    -34,    -77,    -69,     17,    144,
+           202,     90,   -175,   -408,   -365,     48,    611,    862,
+           418,   -640,  -1640,  -1617,     74,   3220,   6687,   8956,
+          8956,   6687,   3220,     74,  -1617,  -1640,   -640,    418,
+           862,    611,     48,   -365,   -408,   -175,     90,    202,
+           144,     17,    -69,    -77,    -34,     13,     36,     31,
+    };
+
+    int16_t hist_[TAPS - 1] = {0};          ///< Last 47 inputs of prior frame
+    int16_t work_[TAPS - 1 + MAX_INPUT];    ///< History + frame, contiguous
+};
+
+// Out-of-class definition: the MAC loop indexes the table at runtime,
+// which odr-uses it, and under the gnu++11 the Arduino core builds with a
+// constexpr member has no implicit definition (C++17 fixed that).  The
+// initializer stays at the declaration above.
+constexpr int16_t Decimator3x::COEFFS_Q15[];
+
+#endif // DECIMATOR_H
@@ -0,0 +1,230 @@
+/**
+ * @file dsp_kernels.h
+ * @brief Hot-loop sample kernels: 32->16-bit extraction and Q15 scaling.
+ *
+ * Every sample the system touches flows through one of these two loops, so
+ * they are kept branch-free, fixed-point, and vectorizable:
+ *
+ *  - dsp_convert32to16(): the INMP441 24-in-32-bit extraction that runs in
+ *    I2SDriver for every captured sample on Core 0.
+ *  - dsp_scale_q15():     the CLEAN_PCM_SCALE attenuation that runs in every
+ *    IAudioProcessor via applyScale() on Core 1.
+ *
+ * KERNEL SELECTION:
+ *   When the ESP-DSP component is present (platformio.ini lib_deps), the
+ *   scale kernel dispatches to dsps_mulc_s16(), which on the ESP32-S3 is
+ *   implemented with the 128-bit PIE SIMD extension (8 int16 lanes per
+ *   EE.VMUL/EE.VLD.128 instruction).  Elsewhere it falls back to the
+ *   portable unrolled Q15 loop below.
+ *
+ *   The 32->16 shift kernel stays a hand-unrolled scalar loop on purpose:
+ *   it is load/store bound (4 bytes in, 2 bytes out per sample, one shift),
+ *   so the unroll already saturates the memory path and a PIE version
+ *   measures within noise.  Revisit if the conversion ever grows real math
+ *   (e.g. dithering).
+ *
+ * Q15 CONVENTION:
+ *   Gains are 1.15 fixed point: gain_q15 = round(gain * 32768), valid for
+ *   gains in [0, 1).  CLEAN_PCM_SCALE = 0.8 -> 26214.  The multiply-high
+ *   ((s * g) >> 15) replaces the old int -> float -> int round trip and
+ *   cannot overflow int16 for gains below unity, so no clamp is needed on
+ *   that path.
+ */
+
+#ifndef DSP_KERNELS_H
+#define DSP_KERNELS_H
+
+#include <stdint.h>
+
+#if __has_include("dsps_mulc.h")
+#include "dsps_mulc.h"
+#define DSP_KERNELS_HAVE_ESP_DSP 1
+#else
+#define DSP_KERNELS_HAVE_ESP_DSP 0
+#endif
+
+/** @brief Convert a float gain in [0, 1) to 1.15 fixed point. */
+static inline int16_t dsp_gain_to_q15(float gain) {
+    int32_t q = static_cast<int32_t>(gain * 32768.0f + 0.5f);
+    if (q > 32767) q = 32767;
+    if (q < 0)     q = 0;
+    return static_cast<int16_t>(q);
+}
+
+/**
+ * @brief Extract int16 PCM from 32-bit I2S slots (INMP441: data in bits 31:8).
+ *
+ * Takes the high 16 bits of each sample -- sign-preserving, same result as
+ * the original per-sample loop, unrolled 4x for the Core 0 hot path.
+ *
+ * @param dst  Destination int16 buffer, `n` samples.
+ * @param src  Source 32-bit I2S slot buffer, `n` samples.
+ * @param n    Sample count (FRAME_SIZE and multiples are always % 4 == 0).
+ */
+static inline void dsp_convert32to16(int16_t* dst, const int32_t* src, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        dst[i + 0] = static_cast<int16_t>(src[i + 0] >> 16);
+        dst[i + 1] = static_cast<int16_t>(src[i + 1] >> 16);
+        dst[i + 2] = static_cast<int16_t>(src[i + 2] >> 16);
+        dst[i + 3] = static_cast<int16_t>(src[i + 3] >> 16);
+    }
+    for (; i < n; ++i) {
+        dst[i] = static_cast<int16_t>(src[i] >> 16);
+    }
+}
+
+/**
+ * @brief Sum of squared samples over an int16 buffer.
+ *
+ * Integer energy kernel backing RMS: int32 lane products accumulated into
+ * a uint64, so a full-scale 480-sample frame (480 * 32768^2 < 2^40) is
+ * exact with no float math in the loop.  ESP-DSP's dsps_dotprod_s16 is NOT
+ * used here -- it right-shifts the accumulator into Q15 and would discard
+ * the low bits we need for quiet-room energies.
+ *
+ * @param src  Source int16 buffer, `n` samples.
+ * @param n    Sample count.
+ * @return     sum(src[i]^2) as uint64.
+ */
+static inline uint64_t dsp_sumsq_s16(const int16_t* src, int n) {
+    uint64_t acc = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // Products fit int32 (max 32768^2 = 2^30); pairwise sums fit uint32.
+        uint32_t p0 = static_cast<uint32_t>(src[i + 0] * src[i + 0]) +
+                      static_cast<uint32_t>(src[i + 1] * src[i + 1]);
+        uint32_t p1 = static_cast<uint32_t>(src[i + 2] * src[i + 2]) +
+                      static_cast<uint32_t>(src[i + 3] * src[i + 3]);
+        acc += static_cast<uint64_t>(p0) + p1;
+    }
+    for (; i < n; ++i) {
+        acc += static_cast<uint32_t>(src[i] * src[i]);
+    }
+    return acc;
+}
+
+/**
+ * @brief Fused 32->16-bit extraction + energy accumulation in one pass.
+ *
+ * Same conversion as dsp_convert32to16(), but squares each extracted
+ * sample while it is still in a register.  The capture path uses this so
+ * frame energy (-> rms_raw) costs zero extra passes over the PCM -- the
+ * data is touched exactly once between DMA buffer and ring slot.
+ *
+ * @param dst  Destination int16 buffer, `n` samples.
+ * @param src  Source 32-bit I2S slot buffer, `n` samples.
+ * @param n    Sample count.
+ * @return     sum(dst[i]^2) as uint64.
+ */
+static inline uint64_t dsp_convert32to16_sumsq(int16_t* dst, const int32_t* src,
+                                               int n) {
+    uint64_t acc = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int16_t s0 = static_cast<int16_t>(src[i + 0] >> 16);
+        int16_t s1 = static_cast<int16_t>(src[i + 1] >> 16);
+        int16_t s2 = static_cast<int16_t>(src[i + 2] >> 16);
+        int16_t s3 = static_cast<int16_t>(src[i + 3] >> 16);
+        dst[i + 0] = s0;
+        dst[i + 1] = s1;
+        dst[i + 2] = s2;
+        dst[i + 3] = s3;
+        uint32_t p0 = static_cast<uint32_t>(s0 * s0) +
+                      static_cast<uint32_t>(s1 * s1);
+        uint32_t p1 = static_cast<uint32_t>(s2 * s2) +
+                      static_cast<uint32_t>(s3 * s3);
+        acc += static_cast<uint64_t>(p0) + p1;
+    }
+    for (; i < n; ++i) {
+        int16_t s = static_cast<int16_t>(src[i] >> 16);
+        dst[i] = s;
+        acc += static_cast<uint32_t>(s * s);
+    }
+    return acc;
+}
+
+/**
+ * @brief Fused stereo deinterleave + 32->16 extraction + per-channel energy.
+ *
+ * Dual-mic variant of dsp_convert32to16_sumsq(): the I2S driver delivers
+ * L/R samples interleaved (L0 R0 L1 R1 ...), and this kernel splits them
+ * into two mono frames in the same single pass that extracts the high 16
+ * bits and accumulates each channel's energy.  Unrolled over two stereo
+ * pairs per iteration -- still one load and one store per sample, so the
+ * deinterleave costs nothing over two mono conversions.
+ *
+ * @param dst0     Destination for channel 0 (left), `nPerCh` samples.
+ * @param dst1     Destination for channel 1 (right), `nPerCh` samples.
+ * @param src      Interleaved 32-bit I2S slot buffer, `2 * nPerCh` samples.
+ * @param nPerCh   Samples per channel (FRAME_SIZE).
+ * @param sumSq0   Out: sum(dst0[i]^2).
+ * @param sumSq1   Out: sum(dst1[i]^2).
+ */
+static inline void dsp_convert32to16_sumsq_2ch(int16_t* dst0, int16_t* dst1,
+                                               const int32_t* src, int nPerCh,
+                                               uint64_t* sumSq0,
+                                               uint64_t* sumSq1) {
+    uint64_t acc0 = 0, acc1 = 0;
+    int i = 0;
+    for (; i + 2 <= nPerCh; i += 2) {
+        int16_t l0 = static_cast<int16_t>(src[2 * i + 0] >> 16);
+        int16_t r0 = static_cast<int16_t>(src[2 * i + 1] >> 16);
+        int16_t l1 = static_cast<int16_t>(src[2 * i + 2] >> 16);
+        int16_t r1 = static_cast<int16_t>(src[2 * i + 3] >> 16);
+        dst0[i + 0] = l0;
+        dst0[i + 1] = l1;
+        dst1[i + 0] = r0;
+        dst1[i + 1] = r1;
+        acc0 += static_cast<uint32_t>(l0 * l0) +
+                static_cast<uint32_t>(l1 * l1);
+        acc1 += static_cast<uint32_t>(r0 * r0) +
+                static_cast<uint32_t>(r1 * r1);
+    }
+    for (; i < nPerCh; ++i) {
+        int16_t l = static_cast<int16_t>(src[2 * i + 0] >> 16);
+        int16_t r = static_cast<int16_t>(src[2 * i + 1] >> 16);
+        dst0[i] = l;
+        dst1[i] = r;
+        acc0 += static_cast<uint32_t>(l * l);
+        acc1 += static_cast<uint32_t>(r * r);
+    }
+    *sumSq0 = acc0;
+    *sumSq1 = acc1;
+}
+
+/**
+ * @brief Scale int16 PCM by a Q15 gain: dst[i] = (src[i] * gainQ15) >> 15.
+ *
+ * For gains below unity the product of int16 * Q15(<32768) cannot exceed
+ * int16 range after the shift, so the kernel is clamp-free.  On ESP32-S3
+ * with ESP-DSP present this runs 8 lanes at a time in the PIE SIMD unit.
+ *
+ * @param dst      Destination int16 buffer, `n` samples (may alias src).
+ * @param src      Source int16 buffer, `n` samples.
+ * @param n        Sample count.
+ * @param gainQ15  Gain in 1.15 fixed point (see dsp_gain_to_q15()).
+ */
+static inline void dsp_scale_q15(int16_t* dst, const int16_t* src, int n,
+                                 int16_t gainQ15) {
+#if DSP_KERNELS_HAVE_ESP_DSP
+    // S3 build of dsps_mulc_s16 is the PIE-vectorized multiply-high.
+    if (dsps_mulc_s16(src, dst, n, gainQ15, 1, 1) == ESP_OK) {
+        return;
+    }
+    // Fall through to the portable loop on unexpected error.
+#endif
+    const int32_t g = gainQ15;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        dst[i + 0] = static_cast<int16_t>((src[i + 0] * g) >> 15);
+        dst[i + 1] = static_cast<int16_t>((src[i + 1] * g) >> 15);
+        dst[i + 2] = static_cast<int16_t>((src[i + 2] * g) >> 15);
+        dst[i + 3] = static_cast<int16_t>((src[i + 3] * g) >> 15);
+    }
+    for (; i < n; ++i) {
+        dst[i] = static_cast<int16_t>((src[i] * g) >> 15);
+    }
+}
+
+#endif // DSP_KERNELS_H
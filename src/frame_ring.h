@@ -0,0 +1,186 @@
+/**
+ * @file frame_ring.h
+ * @brief Lock-free single-producer/single-consumer ring of audio frame slots.
+ *
+ * WHY THIS EXISTS:
+ *   The original pipeline moved audio between tasks with
+ *   xQueueCreate(QUEUE_DEPTH, sizeof(AudioBuffer)) -- every frame was copied
+ *   968 bytes INTO the queue by taskAudioCapture and 968 bytes OUT again by
+ *   taskAudioProcessing (~192 KB/s of cross-core memcpy at 100 frames/s).
+ *
+ *   This ring keeps the frames themselves stationary: the capture task
+ *   acquires a free slot, I2SDriver::read() writes PCM directly into it, and
+ *   only a 1-byte slot index travels through the FreeRTOS queue.  The queue
+ *   is retained purely for its blocking-receive semantics (the processing
+ *   task still sleeps until a frame is ready); the payload never moves.
+ *
+ * CONCURRENCY MODEL (strictly SPSC):
+ *   - taskAudioCapture (Core 0) is the only producer: acquire() + publish().
+ *   - taskAudioProcessing (Core 1) is the only consumer: receive() + release().
+ *   - head_ is written only by the producer, tail_ only by the consumer.
+ *     Slots are recycled strictly in FIFO order, so head_/tail_ fully
+ *     describe which slots are live.  The index queue provides the
+ *     cross-core ordering barrier for the slot contents.
+ *
+ *   Any use beyond one producer + one consumer task is undefined.
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "protocol_schema.h"
+
+/**
+ * @brief Queue element carrying one captured audio frame between tasks.
+ *
+ * NOTE: This is the *internal* capture format.
+ *       Wire protocol format is defined in protocol_schema.h (AudioFrame).
+ */
+struct AudioBuffer {
+    int16_t  pcm[FRAME_SIZE];   ///< Raw PCM samples from I2S DMA
+    uint32_t sequence;          ///< Monotonic frame-time counter (channels
+                                ///  captured together share one sequence)
+    uint32_t timestampUs;       ///< Capture timestamp from micros()
+    uint64_t energySumSq;       ///< sum(pcm[i]^2), computed during the
+                                ///  32->16 conversion pass (free RMS input)
+    uint8_t  channel;           ///< Capture channel id (0 = mono / left)
+};
+
+/**
+ * @class FrameRing
+ * @brief Fixed pool of AudioBuffer slots shared zero-copy between the
+ *        capture and processing tasks.
+ *
+ * Usage (producer side, taskAudioCapture):
+ *   AudioBuffer* slot = ring.acquire();      // nullptr when ring is full
+ *   g_i2s.read(slot->pcm, ...);              // DMA conversion writes in place
+ *   ring.publish(slot);                      // hand index to consumer
+ *
+ * Usage (consumer side, taskAudioProcessing):
+ *   AudioBuffer* buf = ring.receive(portMAX_DELAY);
+ *   ...process...
+ *   ring.release(buf);                       // slot becomes reusable
+ *
+ * @tparam DEPTH  Number of pre-allocated slots (compile-time, no malloc).
+ */
+template <uint8_t DEPTH>
+class FrameRing {
+public:
+    /**
+     * @brief Create the internal index queue.  Call once from setup().
+     * @return true on success; false if queue creation failed.
+     */
+    bool begin() {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        reserved_   = 0;
+        highWater_  = 0;
+        indexQueue_ = xQueueCreate(DEPTH, sizeof(uint8_t));
+        return indexQueue_ != nullptr;
+    }
+
+    /**
+     * @brief Producer: reserve the next free slot for writing.
+     *
+     * Several slots may be reserved before any is published -- when the
+     * capture task drains a DMA backlog it reserves one slot per ready
+     * frame, then fills them all with a single i2s_read().  Reserved
+     * slots must subsequently be
+     * either publish()ed (in reservation order) or abort()ed (newest first).
+     *
+     * @return Pointer to a writable AudioBuffer, or nullptr when all DEPTH
+     *         slots are reserved or in flight (processing task is behind --
+     *         count this as a queue overrun, exactly like the old
+     *         xQueueSend failure).
+     */
+    AudioBuffer* acquire() {
+        if (reserved_ - tail_.load(std::memory_order_acquire) >= DEPTH) {
+            return nullptr;   // Ring full -- caller drops the frame
+        }
+        return &slots_[reserved_++ % DEPTH];
+    }
+
+    /**
+     * @brief Producer: publish a filled slot to the consumer.
+     *
+     * Only the 1-byte slot index crosses the queue; the 968-byte frame
+     * stays where the DMA conversion wrote it.  Slots must be published in
+     * the order they were acquired.
+     *
+     * @param slot  The pointer previously returned by acquire().
+     * @return      true if the index was queued (always succeeds when
+     *              acquire() succeeded, since queue depth == DEPTH).
+     */
+    bool publish(AudioBuffer* slot) {
+        uint8_t index = static_cast<uint8_t>(slot - slots_);
+        uint32_t depth = head_.fetch_add(1, std::memory_order_release) + 1 -
+                         tail_.load(std::memory_order_relaxed);
+        if (depth > highWater_) highWater_ = depth;   // Producer-only write
+        return xQueueSend(indexQueue_, &index, 0) == pdPASS;
+    }
+
+    /**
+     * @brief Producer: un-reserve a slot that will not be filled.
+     *
+     * Used when a batched read comes back short: the trailing reserved
+     * slots hold no data and are handed straight back.  Aborts must be the
+     * most recent reservations, with no publish() after them in the same
+     * batch -- exactly the pattern taskAudioCapture follows.
+     */
+    void abort(AudioBuffer* /*slot*/) {
+        reserved_--;
+    }
+
+    /**
+     * @brief Consumer: block until a published frame is available.
+     * @param timeoutTicks  Maximum wait (pass portMAX_DELAY to wait forever).
+     * @return Pointer to the oldest published frame, or nullptr on timeout.
+     */
+    AudioBuffer* receive(TickType_t timeoutTicks) {
+        uint8_t index;
+        if (xQueueReceive(indexQueue_, &index, timeoutTicks) != pdTRUE) {
+            return nullptr;
+        }
+        return &slots_[index];
+    }
+
+    /**
+     * @brief Consumer: return a slot to the free pool after processing.
+     *
+     * Slots MUST be released in the order they were received (FIFO) --
+     * guaranteed automatically as long as the consumer processes one frame
+     * at a time, which taskAudioProcessing does.
+     */
+    void release(AudioBuffer* /*slot*/) {
+        tail_.fetch_add(1, std::memory_order_release);
+    }
+
+    /** @brief Number of published-but-unprocessed frames (telemetry only). */
+    uint32_t depth() const {
+        return head_.load(std::memory_order_relaxed) -
+               tail_.load(std::memory_order_relaxed);
+    }
+
+    /** @brief Deepest the ring has been since the last clearHighWater() --
+     *         shows the queue FILLING long before an overrun drops a frame. */
+    uint32_t highWater() const { return highWater_; }
+
+    /** @brief Restart watermark tracking (stats reporter, per interval). */
+    void clearHighWater() { highWater_ = 0; }
+
+    /** @brief Compile-time capacity, mirrors Config::QUEUE_DEPTH. */
+    static constexpr uint8_t capacity() { return DEPTH; }
+
+private:
+    AudioBuffer           slots_[DEPTH];       ///< Static slot pool -- no heap
+    std::atomic<uint32_t> head_{0};            ///< Published count (producer-written)
+    std::atomic<uint32_t> tail_{0};            ///< Released count (consumer-written)
+    uint32_t              reserved_ = 0;       ///< Reserved count (producer-private)
+    uint32_t              highWater_ = 0;      ///< Max depth since last clear
+                                               ///  (producer-written, stats-read)
+    QueueHandle_t         indexQueue_ = nullptr; ///< Carries 1-byte slot indices
+};
+
+#endif // FRAME_RING_H
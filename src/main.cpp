@@ -19,45 +19,98 @@
  *  - All denoising/inference logic lives inside classes that implement IAudioProcessor.
  *  - To swap in an AI model, create a new IAudioProcessor subclass and pass it to
  *    g_pipeline.begin() in setup(). No other code needs to change.
- *  - The default ScaledPassThroughProcessor scales output by CLEAN_PCM_SCALE (0.8)
- *    instead of a raw copy.  This headroom guarantees the visualizer never clips
- *    when the AI model is integrated and its output is louder than expected.
+ *  - Processors can be composed: g_pipeline.begin() also accepts an array of
+ *    stages (e.g. DC-block -> denoiser -> AGC) run through ProcessorChain
+ *    with a shared ping-pong scratch pair -- no per-stage buffers.
+ *  - The pipeline applies CLEAN_PCM_SCALE (0.8) once after the last stage.
+ *    This headroom guarantees the visualizer never clips when the AI model
+ *    is integrated and its output is louder than expected, and it never
+ *    compounds no matter how many stages run.
  *
  * How to Add a New AI Model:
  *  1. Create a class that inherits from IAudioProcessor.
  *  2. Load your model in init() — SPIFFS, SD card, or compiled-in weights.
  *  3. Run inference in processFrame() — convert int16→float, infer, convert back.
  *  4. Return the model's VAD probability (0.0–1.0).
- *  5. In setup(), replace `static ScaledPassThroughProcessor proc;`
+ *  5. In setup(), replace `static PassThroughProcessor proc;`
  *     with     `static MyAIModelProcessor proc;`
- *     and update g_pipeline.begin(&proc, g_audioQueue).
+ *     and update g_pipeline.begin(&proc).
  */
 
 #include <Arduino.h>
 #include <WiFi.h>
+#include <Preferences.h>       // NVS-backed WiFi fast-connect cache
+#include <type_traits>
+
+// WebSocket transport selection: prefer the event-driven ESP-IDF native
+// client (runs in its own task, no polling) when the component is in the
+// build; otherwise fall back to the Arduino WebSocketsClient, which must
+// be pumped from loop().  WebSocketManager hides the difference.
+#if defined(__has_include)
+#if __has_include(<esp_websocket_client.h>)
+#define WS_NATIVE_CLIENT 1
+#endif
+#endif
+#if WS_NATIVE_CLIENT
+#include <esp_websocket_client.h>
+#else
 #include <WebSocketsClient.h>
+#endif
+
+// Scatter-gather batch transmission: compose the wire message from segment
+// descriptors pointing into the batch pool (header + frame headers + pcm)
+// and ship it as one fragmented WebSocket message -- no contiguous
+// WIRE_BATCH_V2_MAX staging buffer, no payload memcpy.  Needs the native
+// client's partial-send API (esp_websocket_client >= 1.2); define
+// WS_NO_GATHER_SEND to force the contiguous encode on older components.
+#if WS_NATIVE_CLIENT && !defined(WS_NO_GATHER_SEND)
+#define WS_GATHER_SEND 1
+#else
+#define WS_GATHER_SEND 0
+#endif
+
 #include <driver/i2s.h>
+#include <esp_heap_caps.h>     // Internal-SRAM headroom queries (memory monitor)
 #include "protocol_schema.h"   // AudioFrame, BatchPacket, BatchHeader definitions
+#include "wire_format.h"       // v2 wire encoder (payload modes)
+#include "frame_ring.h"        // AudioBuffer + zero-copy SPSC slot ring
+#include "dsp_kernels.h"       // Fixed-point/SIMD sample kernels
+#include "decimator.h"         // 3:1 polyphase stage for 16 kHz mode
+#include "telemetry.h"         // Counters + per-stage cycle histograms
+#include "spill_buffer.h"      // PSRAM outage spill ring for sealed batches
+#include "arena_pool.h"        // Tensor-arena pool (internal RAM + PSRAM)
+#include "bench.h"             // Setup-time micro-benchmark harness
+#include "replay.h"            // Deterministic PCM replay through the pipeline
 #include "config.h"            // CONFIG_WIFI_SSID, CONFIG_WIFI_PASS macros
 
-// ============================================================================
-// PROTOCOL CONSTANTS  (must match protocol_schema.h exactly)
-// ============================================================================
-
-#ifndef PROTOCOL_MAGIC
-#define PROTOCOL_MAGIC    0xABCD1234u
-#endif
-
-#ifndef PROTOCOL_VERSION
-#define PROTOCOL_VERSION  0x01u
-#endif
+// Define (or add -DBENCH_ON_BOOT to build_flags) to run the micro-benchmark
+// suite unconditionally at every boot.  Without it, the suite can still be
+// triggered by holding 'b' on the serial console during the 2 s boot window.
+// #define BENCH_ON_BOOT
+
+// Same for the replay harness (replay.h): define REPLAY_ON_BOOT, or hold
+// 'r' during the boot window.  Runs after the processor is attached so
+// the replay exercises whatever setup() actually selected.
+// #define REPLAY_ON_BOOT
+
+// Production builds that know the processor type at flash time can bind it
+// statically, e.g. -DPIPELINE_STATIC_PROCESSOR=PassThroughProcessor.  The
+// pipeline then calls that type's processFrame() through a qualified
+// (non-virtual) call, letting the compiler inline the whole frame path --
+// for passthrough, the memcpy and the Q15 headroom scale fuse into one
+// straight-line loop with no indirect branch per frame.  The virtual
+// strategy interface stays fully functional: dev builds leave this
+// undefined, and even a static build demotes itself back to virtual
+// dispatch if the init-failure fallback or a hot swap replaces the bound
+// processor (see AudioPipeline::invokeProcessor()).
+// #define PIPELINE_STATIC_PROCESSOR PassThroughProcessor
 
 // ============================================================================
 // TUNING CONSTANTS
 // ============================================================================
 
 /**
- * @brief Output amplitude scale applied to clean_pcm by every processor.
+ * @brief Output amplitude scale applied to clean_pcm by the pipeline.
  *
  * WHY 0.8:
  *   A pure-copy passthrough outputs samples at full scale.  When an AI model
@@ -67,12 +120,23 @@
  *     * AI model output (which is already attenuated by the model) sits
  *       comfortably within range without additional clamping logic.
  *
+ * WHERE IT IS APPLIED:
+ *   Once, by AudioPipeline, after the last processor stage has run.
+ *   Processors write unscaled output; the scale can therefore never
+ *   compound across a ProcessorChain (0.8 per stage would be -2 dB each).
+ *
  * CHANGING THIS VALUE:
- *   Adjust only this constant.  All IAudioProcessor implementations call the
- *   shared helper applyScale() — no per-class change required.
+ *   Adjust only this constant -- no per-class change required.  It is
+ *   also the boot default: the server can retune the live scale over the
+ *   downlink (WIRE_CTRL_SET_CLEAN_SCALE) without a reflash.
  */
 static constexpr float CLEAN_PCM_SCALE = 0.8f;
 
+/// CLEAN_PCM_SCALE in 1.15 fixed point -- the hot path applies the scale as
+/// a Q15 multiply-high (see dsp_kernels.h), no float round trip per sample.
+static constexpr int16_t CLEAN_PCM_SCALE_Q15 =
+    static_cast<int16_t>(CLEAN_PCM_SCALE * 32768.0f + 0.5f);
+
 // ============================================================================
 // CONFIGURATION  (all compile-time constants, no magic numbers in code)
 // ============================================================================
@@ -85,6 +149,13 @@ namespace Config {
     constexpr int         WS_PORT   = 8080;
     constexpr const char* WS_PATH   = "/";
 
+    // WiFi fast-connect: how long the NVS-cached targeted association
+    // (pinned BSSID + channel + static lease) may take before we conclude
+    // the cache is stale -- AP rebooted onto another channel, lease
+    // reassigned -- and fall back to a full scan with DHCP.  A warm
+    // association completes in 300-700 ms, so 3 s is already generous.
+    constexpr uint32_t WIFI_FAST_CONNECT_TIMEOUT_MS = 3000;
+
     // I2S Pins (INMP441)
     // BCLK must equal 64 x WS at 48 kHz -> BCLK = 3.072 MHz (Design Doc 4.2)
     constexpr gpio_num_t I2S_SCK = GPIO_NUM_4;
@@ -92,18 +163,148 @@ namespace Config {
     constexpr gpio_num_t I2S_SD  = GPIO_NUM_6;
 
     // RTOS Task Config
-    constexpr uint32_t    TASK_STACK_MIC  = 4096;
-    constexpr uint32_t    TASK_STACK_PROC = 8192;
-    constexpr UBaseType_t TASK_PRIO_MIC   = 10;   // High — never miss I2S DMA
-    constexpr UBaseType_t TASK_PRIO_PROC  = 5;    // Medium — inference + send
-    constexpr BaseType_t  CORE_MIC        = 0;
-    constexpr BaseType_t  CORE_PROC       = 1;
-
-    // Queue depth >= 8 so the high-priority I2S task never blocks on a slow
-    // RNNoise inference frame (Design Doc 9.2)
-    constexpr uint8_t QUEUE_DEPTH = 8;
+    constexpr uint32_t    TASK_STACK_MIC    = 4096;
+    constexpr uint32_t    TASK_STACK_PROC   = 8192;
+    constexpr uint32_t    TASK_STACK_SENDER = 4096;
+    constexpr UBaseType_t TASK_PRIO_MIC     = 10;   // High — never miss I2S DMA
+    constexpr UBaseType_t TASK_PRIO_PROC    = 5;    // Medium — inference only
+    constexpr UBaseType_t TASK_PRIO_SENDER  = 3;    // Low — WiFi may stall it
+    constexpr BaseType_t  CORE_MIC          = 0;
+    constexpr BaseType_t  CORE_PROC         = 1;
+    constexpr BaseType_t  CORE_SENDER       = 1;    // Preempted by inference
+
+    // Memory watchdog (stats-interval sampling in loop()).  The stack
+    // sizes above are guesses; the monitor reports how far each task's
+    // high-watermark actually sits above zero, and alarms when the
+    // headroom gets thin enough that one deep call chain could smash it.
+    // Heap threshold watches internal SRAM -- the scarce pool once a
+    // tensor arena lands; PSRAM fragmentation is not the concern here.
+    constexpr uint32_t MEM_ALARM_STACK_FREE = 512;       // bytes per task
+    constexpr uint32_t MEM_ALARM_HEAP_FREE  = 16 * 1024; // bytes internal
+
+    // Capture channels: 1 = single INMP441 (default), 2 = dual mics on the
+    // same I2S bus (L/R select pins tied opposite ways) for server-side
+    // beamforming experiments.  Compile-time because it sizes the ring and
+    // DMA staging; each channel gets its own frame stream tagged with a
+    // channel id through the whole pipeline and wire format.  CAUTION:
+    // processors see the channels interleaved frame by frame, so stages
+    // with per-stream state (DC blocker, denoisers) need per-channel
+    // instances before dual-mic units run anything beyond passthrough.
+    constexpr int CAPTURE_CHANNELS = 1;
+
+    // Queue depth >= 8 frames PER CHANNEL so the high-priority I2S task
+    // never blocks on a slow RNNoise inference frame (Design Doc 9.2) --
+    // dual-mic capture publishes two slots per 10 ms tick.
+    constexpr uint8_t QUEUE_DEPTH = 8 * CAPTURE_CHANNELS;
+
+    // Capture is event-driven: the task sleeps on the I2S event queue and
+    // wakes per DMA-buffer-ready, reading exactly what the driver has.
+    // When inference or the scheduler makes it fall behind, several frames
+    // pile up and get drained in one i2s_read() -- CAPTURE_FRAMES_MAX caps
+    // that burst (and sizes the static DMA staging buffer).  Must stay
+    // well below QUEUE_DEPTH so a burst can always find ring slots.
+    constexpr int CAPTURE_FRAMES_MAX = 4;
+
+    // I2S event queue depth: one entry per DMA buffer is enough for every
+    // RX_DONE plus any overflow events to queue while the task runs.
+    constexpr int I2S_EVENT_QUEUE_LEN = 8;   // == dma_buf_count
+
+    // Batch buffer pool: one buffer is always assembling while the others
+    // can be in flight towards the WebSocket.  2 is the minimum for
+    // assembly/transmit overlap; 3 gives the sender one batch of slack
+    // before inference has to drop a completed batch.  Each buffer is
+    // sized for FRAMES_PER_BATCH_MAX frames (~31 KB) so the batch depth
+    // can be raised at runtime without reallocation.
+    constexpr uint8_t BATCH_BUFFERS = 3;
+
+    // Batch-depth profiles (frames per batch, selectable per session via
+    // WIRE_CTRL_SET_BATCH_FRAMES):
+    //   1-2   low-latency installs (10-20 ms batching delay)
+    //   4     default (40 ms, matches Design Doc v1.2)
+    //   8-16  weak-WiFi installs (amortize WS/TCP overhead per byte)
+    constexpr uint8_t BATCH_FRAMES_LOW_LATENCY = 1;
+    constexpr uint8_t BATCH_FRAMES_DEFAULT     = FRAMES_PER_BATCH;
+    constexpr uint8_t BATCH_FRAMES_BULK        = 12;
+
+    // PSRAM spill ring for WiFi outages: 6 MB holds ~32 s of full-payload
+    // batches (see spill_buffer.h).  Trimmed automatically on boards with
+    // less free PSRAM; zero-cost when the link is up.
+    constexpr size_t SPILL_BYTES = 6 * 1024 * 1024;
+
+    // Spilled batches drained per live batch once the link returns.  Each
+    // live batch is framesPerBatch * 10 ms of wall time, so 3 drains ~4x
+    // realtime catch-up without starving the live queue.
+    constexpr int SPILL_DRAIN_BURST = 3;
+
+    // VAD transmission gate (opt-in via WIRE_CTRL_SET_VAD_GATE).  A frame
+    // counts as silent when BOTH signals agree it carries no speech:
+    // vad_prob below the threshold OR rms below the floor -- the OR matters
+    // because PassThrough pins vad_prob at 0.99, so until a real denoiser
+    // runs, the RMS floor is what actually gates.  100 RMS is ~-50 dBFS,
+    // conservative enough that room tone still transmits.
+    constexpr float GATE_VAD_THRESH = 0.20f;
+    constexpr float GATE_RMS_FLOOR  = 100.0f;
+
+    // Hangover: keep transmitting this many batches after the last active
+    // one so trailing consonants and short pauses never get clipped.
+    // 5 batches = 200 ms at the default depth.
+    constexpr int GATE_HANGOVER_BATCHES = 5;
+
+    // Adaptive backpressure relief: when the frame ring fills to the
+    // threshold (inference running behind), the pipeline bypasses the
+    // processor -- passthrough-cheap copies -- for a few batches instead
+    // of letting the ring overflow and drop frames.  Degraded (undenoised)
+    // audio beats an audible gap.  Threshold at 3/4 capacity leaves a
+    // burst's worth of slack for the capture task while relief kicks in.
+    constexpr uint32_t RELIEF_DEPTH_THRESH = (QUEUE_DEPTH * 3) / 4;
+    constexpr int      RELIEF_HOLD_BATCHES = 4;
+
+    // Pre-roll ring: suppressed batches are parked here and flushed ahead
+    // of the first active batch, so speech onsets keep their lead-in.
+    // 64 KB holds 2 max-depth FULL batches (the evict-oldest ring keeps
+    // exactly the most recent ones).
+    constexpr size_t GATE_PREROLL_BYTES = 64 * 1024;
+
+    // ------------------------------------------------------------------
+    // Power profile (battery deployments)
+    //
+    // When the VAD gate has suppressed POWER_IDLE_AFTER_BATCHES batches
+    // in a row, the capture task enters idle: WiFi drops to modem sleep,
+    // frames stop flowing into the ring (the processing and sender tasks
+    // block on their empty queues for free), and only the I2S DMA drain
+    // plus the energy check -- which the fused conversion kernel already
+    // computes -- keeps running.  The first frame whose RMS crosses
+    // POWER_WAKE_RMS is itself published, so wake-up loses zero audio.
+    //
+    // POWER_SAVE_ENABLE is the compile-time opt-in for battery builds;
+    // mains-powered units keep today's always-on behavior.  Idle also
+    // requires the VAD gate to be on (it supplies the silence signal),
+    // so the server stays in control of when suppression may happen.
+    // ------------------------------------------------------------------
+    constexpr bool     POWER_SAVE_ENABLE       = false;
+    constexpr uint32_t POWER_IDLE_AFTER_BATCHES = 75;   // ~3 s at 40 ms/batch
+    // Wake threshold sits 1.5x above the gate's RMS floor so a room
+    // hovering at the floor cannot bounce idle on and off (hysteresis).
+    constexpr float    POWER_WAKE_RMS          = GATE_RMS_FLOOR * 1.5f;
+
+    // ------------------------------------------------------------------
+    // Sequence-gap handling
+    //
+    // Capture sequence numbers are checked for continuity per channel in
+    // the pipeline; a hole is stamped into the next frame's gap_frames so
+    // the server's time axis never silently drifts.  With GAP_ZERO_FILL
+    // the pipeline additionally injects flagged zero-PCM filler frames
+    // for gaps up to GAP_FILL_MAX, keeping downstream buffers exactly
+    // time-aligned at the cost of shipping silence.  Larger gaps (e.g.
+    // the deliberate ones from low-power idle) are stamped, never filled.
+    // ------------------------------------------------------------------
+    constexpr bool     GAP_ZERO_FILL = false;
+    constexpr uint32_t GAP_FILL_MAX  = 8;   // Frames (80 ms) worth filling
 }
 
+// One frame of audio at 48 kHz / 480 samples = exactly 10 ms
+static constexpr uint32_t FRAME_DURATION_US = 1000000UL * FRAME_SIZE / SAMPLE_RATE;
+
 // ============================================================================
 // SHARED UTILITY: PCM SCALING
 // ============================================================================
@@ -111,16 +312,26 @@ namespace Config {
 /**
  * @brief Scale each PCM sample in `src` by `scale` and write to `dst`.
  *
- * Result is clamped to [INT16_MIN, INT16_MAX] to prevent wrap-around.
- * All IAudioProcessor implementations MUST route their output through this
- * function so the scale factor is enforced uniformly.
+ * The pipeline routes every finished clean frame through this function --
+ * once, after the last processor stage -- so the headroom factor is
+ * enforced uniformly no matter which processors ran.
+ *
+ * For attenuating scales (< 1.0, the normal case -- CLEAN_PCM_SCALE = 0.8)
+ * this runs the clamp-free Q15 kernel from dsp_kernels.h, SIMD-vectorized
+ * on the S3 when ESP-DSP is present.  Scales >= 1.0 take the original
+ * float loop with saturation to prevent wrap-around.
  *
- * @param dst    Destination int16 buffer (FRAME_SIZE samples, pre-allocated)
- * @param src    Source int16 buffer      (FRAME_SIZE samples, read-only)
+ * @param dst    Destination int16 buffer (`n` samples, pre-allocated)
+ * @param src    Source int16 buffer      (`n` samples, read-only)
+ * @param n      Sample count (FRAME_SIZE, or FRAME_SIZE_16K in 16 kHz mode)
  * @param scale  Amplitude multiplier (use CLEAN_PCM_SCALE = 0.8f by default)
  */
-static void applyScale(int16_t* dst, const int16_t* src, float scale) {
-    for (int i = 0; i < FRAME_SIZE; ++i) {
+static void applyScale(int16_t* dst, const int16_t* src, int n, float scale) {
+    if (scale < 1.0f) {
+        dsp_scale_q15(dst, src, n, dsp_gain_to_q15(scale));
+        return;
+    }
+    for (int i = 0; i < n; ++i) {
         float scaled = static_cast<float>(src[i]) * scale;
         if      (scaled >  32767.0f) scaled =  32767.0f;
         else if (scaled < -32768.0f) scaled = -32768.0f;
@@ -138,15 +349,19 @@ static void applyScale(int16_t* dst, const int16_t* src, float scale) {
  *
  * Every concrete processor (passthrough, RNNoise, TFLite, ONNX...) must:
  *  - Implement processFrame() -- the sole inference entry point.
- *  - Call applyScale(output, ..., CLEAN_PCM_SCALE) so downstream consumers
- *    always receive 80%-scaled PCM regardless of the model used.
+ *  - Write UNSCALED output: the pipeline applies CLEAN_PCM_SCALE exactly
+ *    once after the final stage, so chained processors never compound the
+ *    headroom attenuation.
  *  - Optionally override init() / deinit() for resource management.
  *
  * CONTRACT for processFrame():
- *   input  : raw int16 PCM,  FRAME_SIZE (480) samples
- *   output : cleaned int16 PCM, FRAME_SIZE samples, pre-allocated
- *            output MUST be filled via applyScale() (see above)
- *   return : VAD probability [0.0 - 1.0], or -1.0 on hard failure
+ *   input  : raw int16 PCM, `nSamples` samples -- FRAME_SIZE (480) at the
+ *            native rate, FRAME_SIZE_16K (160) in decimated 16 kHz mode
+ *   output : cleaned int16 PCM, `nSamples` samples, pre-allocated,
+ *            full amplitude (NO CLEAN_PCM_SCALE -- pipeline-owned)
+ *   return : VAD probability [0.0 - 1.0], or -1.0 on hard failure.
+ *            Stages with no VAD opinion (filters, AGC) return 1.0 so a
+ *            ProcessorChain's min-composition keeps the denoiser's answer.
  */
 class IAudioProcessor {
 public:
@@ -154,13 +369,57 @@ public:
 
     /**
      * @brief Run inference on one audio frame.
-     * @param input   Raw PCM buffer -- read-only, FRAME_SIZE int16 samples.
-     * @param output  Output PCM buffer -- write here, FRAME_SIZE int16 samples.
-     *                Output MUST be produced via applyScale() to enforce the
-     *                CLEAN_PCM_SCALE headroom guarantee.
-     * @return        VAD probability in [0.0, 1.0], or -1.0 on error.
+     * @param input     Raw PCM buffer -- read-only, `nSamples` int16 samples.
+     * @param output    Output PCM buffer -- write here, `nSamples` samples,
+     *                  at FULL amplitude: the pipeline applies the
+     *                  CLEAN_PCM_SCALE headroom once after the final stage.
+     * @param nSamples  Samples per frame (FRAME_SIZE or FRAME_SIZE_16K --
+     *                  constant within a session segment, changes only at a
+     *                  batch boundary on a rate renegotiation).
+     * @return          VAD probability in [0.0, 1.0], or -1.0 on error.
+     */
+    virtual float processFrame(const int16_t* input, int16_t* output,
+                               int nSamples) = 0;
+
+    /**
+     * @brief Opt in to batched inference.
+     *
+     * Neural denoisers amortize dramatically better when invoked on
+     * several frames at once (one interpreter invoke, one quantize/
+     * dequantize pass, weights stay warm in cache).  A processor that
+     * returns true here is fed whole batches through processBatch()
+     * instead of frame-by-frame calls.
+     *
+     * COST: the pipeline defers inference until the batch is full, adding
+     * up to (frames_per_batch - 1) * 10 ms of latency before the first
+     * frame of the batch is cleaned.  Leave this false for processors
+     * that are already cheap per frame.
+     */
+    virtual bool wantsBatch() const { return false; }
+
+    /**
+     * @brief Run inference on `nFrames` contiguous frames at once.
+     *
+     * Same per-frame contract as processFrame() (unscaled full-amplitude
+     * output, VAD in [0,1] or -1.0), applied to nFrames * frameSamples
+     * samples.
+     * The default implementation simply loops processFrame(), so only
+     * processors that genuinely amortize need to override it.
+     *
+     * @param input         Raw PCM, nFrames * frameSamples, contiguous.
+     * @param output        Cleaned PCM, nFrames * frameSamples, contiguous.
+     * @param vadOut        Per-frame VAD probabilities, nFrames entries.
+     * @param nFrames       Frames in this invocation (1..FRAMES_PER_BATCH_MAX).
+     * @param frameSamples  Samples per frame (see processFrame()).
      */
-    virtual float processFrame(const int16_t* input, int16_t* output) = 0;
+    virtual void processBatch(const int16_t* input, int16_t* output,
+                              float* vadOut, int nFrames, int frameSamples) {
+        for (int f = 0; f < nFrames; f++) {
+            vadOut[f] = processFrame(input  + f * frameSamples,
+                                     output + f * frameSamples,
+                                     frameSamples);
+        }
+    }
 
     /** @brief Human-readable name for telemetry / logs. */
     virtual const char* getName() const = 0;
@@ -168,46 +427,102 @@ public:
     /**
      * @brief One-time initialization (load model, allocate tensor arena, etc.)
      * @return true if ready; false triggers automatic fallback to
-     *         ScaledPassThroughProcessor inside AudioPipeline::begin().
+     *         PassThroughProcessor inside AudioPipeline::begin().
      */
     virtual bool init() { return true; }
 
     /** @brief Release all resources allocated in init(). */
     virtual void deinit() {}
+
+    /** @brief Dump internal timing/state to serial (stats path, off the hot
+     *         loop).  Default: nothing -- ProcessorChain overrides this with
+     *         its per-stage cycle histograms. */
+    virtual void printStats() const {}
 };
 
 // ============================================================================
-// CONCRETE PROCESSOR: SCALED PASS-THROUGH  (default / fallback)
+// CONCRETE PROCESSOR: PASS-THROUGH  (default / fallback)
 // ============================================================================
 
 /**
- * @class ScaledPassThroughProcessor
- * @brief Copies raw audio to clean_pcm with CLEAN_PCM_SCALE attenuation.
+ * @class PassThroughProcessor
+ * @brief Copies raw audio to clean_pcm unchanged (the pipeline applies the
+ *        CLEAN_PCM_SCALE headroom afterwards, as it does for every stage).
  *
  * Use this when:
  *  - No AI model is available yet (development / baseline).
  *  - You want to verify the pipeline without inference overhead.
  *  - Serving as an automatic fallback when AIModelProcessor::init() fails.
- *
- * WHY NOT a raw memcpy:
- *  A raw copy outputs samples at full amplitude.  Once an AI model is
- *  integrated the output amplitude may differ, causing visualization glitches.
- *  Pre-scaling to 0.8 keeps the pipeline consistent before and after the swap.
  */
-class ScaledPassThroughProcessor : public IAudioProcessor {
+class PassThroughProcessor : public IAudioProcessor {
 public:
     /**
-     * @brief Scale input by CLEAN_PCM_SCALE and write to output.
+     * @brief Copy input to output.
      *        Returns a fixed VAD of 0.99 (always-active signal).
      */
-    float processFrame(const int16_t* input, int16_t* output) override {
-        applyScale(output, input, CLEAN_PCM_SCALE);
+    float processFrame(const int16_t* input, int16_t* output,
+                       int nSamples) override {
+        memcpy(output, input, nSamples * sizeof(int16_t));
         return 0.99f;   // Treat every frame as active voice for visualizer
     }
 
-    const char* getName() const override { return "ScaledPassThrough@0.8"; }
+    const char* getName() const override { return "PassThrough"; }
+};
+
+// ============================================================================
+// CONCRETE PROCESSOR: DC BLOCKER  (chain front-end stage)
+// ============================================================================
+
+/**
+ * @class DCBlockProcessor
+ * @brief One-pole DC-removal high-pass: y[n] = x[n] - x[n-1] + a*y[n-1].
+ *
+ * MEMS mics drift a few LSB of DC with temperature, and any offset wastes
+ * headroom and biases RMS.  The pole at a = 0.995 (Q15 32604) puts the
+ * -3 dB corner near 40 Hz at 48 kHz -- below speech, above the drift.
+ * Written as the canonical first stage of a ProcessorChain; costs ~3
+ * integer ops per sample.
+ */
+class DCBlockProcessor : public IAudioProcessor {
+public:
+    float processFrame(const int16_t* input, int16_t* output,
+                       int nSamples) override {
+        int32_t xPrev = xPrev_;
+        int32_t yPrev = yPrev_;
+        for (int i = 0; i < nSamples; i++) {
+            // y and the (x - xPrev) difference both fit comfortably in
+            // int32; the Q15 pole multiply keeps |y| <= |x| + ripple.
+            int32_t y = input[i] - xPrev + ((POLE_Q15 * yPrev) >> 15);
+            xPrev = input[i];
+            if (y >  32767) y =  32767;
+            if (y < -32768) y = -32768;
+            yPrev = y;
+            output[i] = static_cast<int16_t>(y);
+        }
+        xPrev_ = xPrev;
+        yPrev_ = yPrev;
+        return 1.0f;   // No VAD opinion -- neutral for chain composition
+    }
+
+    const char* getName() const override { return "DCBlock@40Hz"; }
+
+private:
+    static constexpr int32_t POLE_Q15 = 32604;   // 0.995 in 1.15 fixed point
+
+    int32_t xPrev_ = 0;   ///< x[n-1] across frame boundaries
+    int32_t yPrev_ = 0;   ///< y[n-1] across frame boundaries
 };
 
+// ============================================================================
+// CONCRETE PROCESSOR: RNNOISE DENOISER  (rnnoise_processor.h)
+// ============================================================================
+// Included here rather than with the top-of-file headers because it extends
+// IAudioProcessor, which this translation unit defines above.  The processor
+// itself is self-contained (FFT, band analysis, quantized GRU, synthesis);
+// see the file header for the weights/ESP-DSP build requirements.
+
+#include "rnnoise_processor.h"
+
 // ============================================================================
 // CONCRETE PROCESSOR: AI MODEL  (placeholder -- implement your model here)
 // ============================================================================
@@ -221,30 +536,33 @@ public:
  *
  *  Step 1 -- init():
  *    - Mount SPIFFS / SD card if model weights are stored externally.
- *    - Allocate a static tensor arena:
- *        static uint8_t tensorArena[YOUR_ARENA_SIZE];
+ *    - Request a tensor arena from the pool (NOT a static array -- the
+ *      pool is what lets two model variants coexist during a hot swap):
+ *        arena_ = g_arenaPool.acquire(YOUR_ARENA_SIZE);
+ *        if (arena_ == nullptr) return false;
  *    - Create TfLiteModel / OnnxSession from file or embedded array.
  *    - Verify input tensor shape: [1, FRAME_SIZE] float32.
  *    - Return false on any failure -> pipeline auto-falls back to
- *      ScaledPassThroughProcessor so audio keeps flowing.
+ *      PassThroughProcessor so audio keeps flowing.
  *
  *  Step 2 -- processFrame():
  *    (a) Normalize:  float normIn[FRAME_SIZE];
  *                    for (i) normIn[i] = input[i] / 32768.0f;
  *    (b) Run model:  interpreter->Invoke() / session->Run(...)
  *    (c) Read output tensor (float array, same length as input).
- *    (d) Convert back to int16 via applyScale() -- MANDATORY:
- *                    applyScale(output, rawInt16Buf, CLEAN_PCM_SCALE);
- *        or inline the scale:
- *                    for (i) output[i] = clamp(normOut[i] * 32768.0f * CLEAN_PCM_SCALE)
+ *    (d) Convert back to int16 at FULL amplitude:
+ *                    for (i) output[i] = clamp(normOut[i] * 32768.0f)
+ *        Do NOT apply CLEAN_PCM_SCALE here -- the pipeline scales once
+ *        after the last stage.
  *    (e) Return the model VAD probability (0.0-1.0).
  *
  *  Step 3 -- deinit():
  *    - Delete interpreter / session.
+ *    - Return the arena: g_arenaPool.release(arena_); arena_ = nullptr;
  *    - Unmount filesystem if needed.
  *
  *  Step 4 -- Activate in setup():
- *    Replace:  static ScaledPassThroughProcessor proc;
+ *    Replace:  static PassThroughProcessor proc;
  *    With:     static AIModelProcessor proc;
  * ─────────────────────────────────────────────────────────────────────────
  */
@@ -252,33 +570,33 @@ class AIModelProcessor : public IAudioProcessor {
 public:
     bool init() override {
         // TODO: Load model weights (SPIFFS / SD / embedded array)
-        // TODO: Allocate tensor arena
+        // TODO: arena_ = g_arenaPool.acquire(<arena size>); fail if nullptr
         // TODO: Initialize interpreter / session
         // TODO: Validate input / output tensor shapes
         Serial.println("[AI] Model loading not implemented yet -- "
-                       "falling back to ScaledPassThrough");
+                       "falling back to PassThrough");
         return false;   // Returning false triggers automatic fallback
     }
 
     /**
      * @brief AI model inference stub.
      *
-     * Replace the applyScale() call below with real inference.
-     * The applyScale() call MUST be retained (or equivalent inline logic)
-     * to honour the CLEAN_PCM_SCALE contract.
+     * Replace the copy below with real inference.  Output full-amplitude
+     * PCM -- the pipeline applies the CLEAN_PCM_SCALE headroom itself.
      */
-    float processFrame(const int16_t* input, int16_t* output) override {
+    float processFrame(const int16_t* input, int16_t* output,
+                       int nSamples) override {
         // TODO: Replace this block with real inference
         //
         //   float normIn[FRAME_SIZE];
-        //   for (int i = 0; i < FRAME_SIZE; ++i)
+        //   for (int i = 0; i < nSamples; ++i)
         //       normIn[i] = input[i] / 32768.0f;
         //
         //   /* ... run model ... */
         //
         //   float normOut[FRAME_SIZE];  // model output
-        //   for (int i = 0; i < FRAME_SIZE; ++i) {
-        //       float s = normOut[i] * 32768.0f * CLEAN_PCM_SCALE;
+        //   for (int i = 0; i < nSamples; ++i) {
+        //       float s = normOut[i] * 32768.0f;   // full amplitude
         //       if (s >  32767.f) s =  32767.f;
         //       if (s < -32768.f) s = -32768.f;
         //       output[i] = static_cast<int16_t>(s);
@@ -286,7 +604,7 @@ public:
         //   return vadProbFromModel;
         //
         // Fallback until real inference is ready:
-        applyScale(output, input, CLEAN_PCM_SCALE);
+        memcpy(output, input, nSamples * sizeof(int16_t));
         return 0.5f;   // Placeholder VAD
     }
 
@@ -294,44 +612,158 @@ public:
 
     void deinit() override {
         // TODO: Release model resources
+        g_arenaPool.release(arena_);
+        arena_ = nullptr;
     }
 
 private:
-    // TODO: Add model handle, tensor arena, interpreter pointer here
+    void* arena_ = nullptr;   ///< Tensor arena leased from g_arenaPool
+
+    // TODO: Add model handle, interpreter pointer here
     //   e.g.:
-    //   static uint8_t  s_tensorArena[96 * 1024];
     //   TfLiteInterpreter* interpreter_ = nullptr;
 };
 
 // ============================================================================
-// DATA STRUCTURES  (internal pipeline types, not wire protocol)
+// PROCESSOR COMPOSITION: CHAIN
 // ============================================================================
 
 /**
- * @brief Queue element carrying one captured audio frame between tasks.
+ * @class ProcessorChain
+ * @brief Runs several IAudioProcessor stages back to back as one processor.
  *
- * NOTE: This is the *internal* queue format.
- *       Wire protocol format is defined in protocol_schema.h (AudioFrame).
+ * The practical pipeline is rarely a single model: DC-block, then the
+ * denoiser, then perhaps AGC.  Writing that as one monolithic processor
+ * means hand-managed intermediate buffers in every combination; the chain
+ * instead threads the frame through a shared ping-pong scratch pair --
+ * two int16[FRAME_SIZE] buffers total, regardless of stage count, and the
+ * final stage writes straight into the caller's output (no trailing copy).
+ *
+ * VAD COMPOSITION: the chain reports the MINIMUM over all stages.  Stages
+ * without a VAD opinion return 1.0 (see IAudioProcessor contract), so the
+ * denoiser's estimate survives; any stage returning -1.0 (hard failure)
+ * fails the whole frame.
+ *
+ * TIMING: each stage gets its own CycleHist, recorded around the stage
+ * call with the same cycle counter the global telemetry uses.  The
+ * aggregate chain still lands in TSTAGE_INFERENCE; printStats() breaks it
+ * down per stage on the 10-second stats path.
  */
-struct AudioBuffer {
-    int16_t  pcm[FRAME_SIZE];   ///< Raw PCM samples from I2S DMA
-    uint32_t sequence;          ///< Global monotonic frame counter
-    uint32_t timestampUs;       ///< Capture timestamp from micros()
+class ProcessorChain : public IAudioProcessor {
+public:
+    static constexpr int MAX_STAGES = 4;
+
+    /**
+     * @brief Append a stage.  Call before AudioPipeline::begin(); order of
+     *        calls is order of execution.
+     * @return false when the chain is full.
+     */
+    bool add(IAudioProcessor* stage) {
+        if (stageCount_ >= MAX_STAGES || stage == nullptr) return false;
+        stages_[stageCount_++] = stage;
+        return true;
+    }
+
+    bool init() override {
+        for (int s = 0; s < stageCount_; s++) {
+            if (!stages_[s]->init()) {
+                Serial.printf("[Chain] Stage '%s' init failed\n",
+                              stages_[s]->getName());
+                return false;   // Pipeline falls back to PassThrough
+            }
+        }
+        return stageCount_ > 0;
+    }
+
+    void deinit() override {
+        for (int s = stageCount_ - 1; s >= 0; s--) stages_[s]->deinit();
+    }
+
+    float processFrame(const int16_t* input, int16_t* output,
+                       int nSamples) override {
+        const int16_t* cur = input;
+        float vad = 1.0f;
+
+        for (int s = 0; s < stageCount_; s++) {
+            // Last stage writes the real output; earlier stages ping-pong
+            // between the two shared scratch buffers.
+            int16_t* dst = (s == stageCount_ - 1) ? output : scratch_[s & 1];
+
+            const uint32_t t0 = telemetryCycles();
+            float v = stages_[s]->processFrame(cur, dst, nSamples);
+            stageHist_[s].record(telemetryCycles() - t0);
+
+            if (v < 0.0f) return -1.0f;   // Stage failure fails the frame
+            if (v < vad)  vad = v;        // Most skeptical stage wins
+            cur = dst;
+        }
+        return vad;
+    }
+
+    const char* getName() const override { return "Chain"; }
+
+    /** @brief Per-stage p50/p99/max on the stats path (loop(), 10 s). */
+    void printStats() const override {
+        for (int s = 0; s < stageCount_; s++) {
+            const CycleHist& h = stageHist_[s];
+            if (h.samples == 0) continue;
+            Serial.printf("[Stats]   chain:%-12s p50=%6luus  p99=%6luus  max=%6luus\n",
+                          stages_[s]->getName(),
+                          h.percentileUs(50),
+                          h.percentileUs(99),
+                          h.maxCycles / TELEMETRY_CYCLES_PER_US);
+        }
+    }
+
+private:
+    IAudioProcessor* stages_[MAX_STAGES] = {nullptr};
+    int              stageCount_ = 0;
+    CycleHist        stageHist_[MAX_STAGES];
+
+    // Shared ping-pong scratch: sized for the native rate, reused by every
+    // stage transition -- chains allocate nothing per stage.
+    int16_t scratch_[2][FRAME_SIZE];
 };
 
+// ============================================================================
+// DATA STRUCTURES  (internal pipeline types, not wire protocol)
+// ============================================================================
+
+// AudioBuffer lives in frame_ring.h together with the zero-copy slot ring
+// that replaced the old copy-in/copy-out FreeRTOS queue.
+
 /**
  * @brief Accumulates AudioFrames until a full batch of FRAMES_PER_BATCH is ready.
- *        Only accessed from the processing task -- not thread-safe by design.
+ *
+ * Holds a pool of Config::BATCH_BUFFERS wire-protocol packets rotated
+ * between an "assembling" role (written by the processing task) and a
+ * "transmitting" role (read by whoever sends it).  The rotation means
+ * processFrame() always has a buffer to write into while a completed batch
+ * is still on its way out -- a WiFi hiccup inside the send no longer backs
+ * up into the frame ring.
+ *
+ * Assembly state (active/frameCount/batchSequence) is owned by the
+ * processing task; only inFlight is shared with the transmit side.
  */
 struct BatchAssembler {
-    BatchPacket packet;               ///< Wire-protocol batch being built
-    uint8_t     frameCount    = 0;    ///< Frames accumulated so far
-    uint32_t    batchSequence = 0;    ///< Incremented each time a batch is sent
+    BatchPacket packets[Config::BATCH_BUFFERS]; ///< Static pool, no malloc
+    uint8_t     active        = 0;    ///< Index of the buffer being assembled
+    uint8_t     frameCount    = 0;    ///< Frames accumulated in active buffer
+    uint32_t    batchSequence = 0;    ///< Incremented each time a batch is sealed
+    std::atomic<uint8_t> inFlight{0}; ///< Buffers handed out for transmission
+
+    /** @brief Buffer currently being assembled. */
+    BatchPacket& assembling() { return packets[active]; }
 
     /** @brief Reset frame count and clear header before starting a new batch. */
     void reset() {
         frameCount = 0;
-        memset(&packet.header, 0, sizeof(packet.header));
+        memset(&assembling().header, 0, sizeof(BatchHeader));
+    }
+
+    /** @brief True if rotating forward would collide with an in-flight buffer. */
+    bool allOthersInFlight() const {
+        return inFlight.load(std::memory_order_acquire) >= Config::BATCH_BUFFERS - 1;
     }
 };
 
@@ -348,28 +780,36 @@ struct BatchAssembler {
  */
 class AudioPipeline {
 public:
-    AudioPipeline() : processor_(nullptr), queue_(nullptr) {}
+    AudioPipeline() : processor_(nullptr) {}
 
     /**
-     * @brief Attach a processor and the shared audio queue.
+     * @brief Attach a processor.
      *
      * If processor->init() returns false, the pipeline automatically
-     * substitutes a ScaledPassThroughProcessor so audio keeps flowing.
+     * substitutes a PassThroughProcessor so audio keeps flowing.
      *
      * @param processor Pointer to an IAudioProcessor implementation.
-     * @param queue     FreeRTOS queue producing AudioBuffer items.
      * @return          Always true (fallback guarantees success).
      */
-    bool begin(IAudioProcessor* processor, QueueHandle_t queue) {
+    bool begin(IAudioProcessor* processor) {
         processor_ = processor;
-        queue_     = queue;
+#ifdef PIPELINE_STATIC_PROCESSOR
+        // Contract: a static-bound build passes an instance of exactly the
+        // bound type here (setup() owns that).  Everything that can break
+        // the assumption below or later demotes to virtual dispatch.
+        staticBind_ = true;
+#endif
 
         if (!processor_->init()) {
-            Serial.printf("[Pipeline] '%s' init failed -- switching to ScaledPassThrough\n",
+            Serial.printf("[Pipeline] '%s' init failed -- switching to PassThrough\n",
                           processor_->getName());
-            static ScaledPassThroughProcessor fallback;
+            static PassThroughProcessor fallback;
             processor_ = &fallback;
             processor_->init();
+#ifdef PIPELINE_STATIC_PROCESSOR
+            staticBind_ = std::is_same<PIPELINE_STATIC_PROCESSOR,
+                                       PassThroughProcessor>::value;
+#endif
         }
 
         assembler_.reset();
@@ -377,55 +817,618 @@ public:
         return true;
     }
 
+    /**
+     * @brief Attach a chain of processors, executed in array order.
+     *
+     * Stages share the chain's ping-pong scratch pair and are timed
+     * individually (see ProcessorChain).  Same fallback rule as the
+     * single-processor overload: if any stage fails init(), the whole
+     * chain is replaced by PassThrough.
+     *
+     * @param stages  Array of stage pointers, e.g. {&dcBlock, &rnnoise}.
+     * @param n       Stage count (1..ProcessorChain::MAX_STAGES).
+     * @return        Always true (fallback guarantees success).
+     */
+    bool begin(IAudioProcessor* const stages[], int n) {
+        for (int s = 0; s < n; s++) {
+            if (!chain_.add(stages[s])) {
+                Serial.printf("[Pipeline] Chain limited to %d stages -- "
+                              "'%s' and later dropped\n",
+                              ProcessorChain::MAX_STAGES,
+                              stages[s]->getName());
+                break;
+            }
+        }
+        return begin(&chain_);
+    }
+
     /**
      * @brief Feed one captured frame through inference and into the batch.
      *
-     * Internally calls processor_->processFrame(), which MUST produce output
-     * via applyScale() (enforced by the IAudioProcessor contract).
-     * The 0.8 scale is therefore baked into every clean_pcm in the batch.
+     * Runs the attached processor (or chain) on the frame, then applies
+     * CLEAN_PCM_SCALE exactly once, so the 0.8 headroom is baked into
+     * every clean_pcm in the batch regardless of how many stages ran.
      *
      * @param buffer  Frame captured by taskAudioCapture.
      * @return        true when a complete batch of FRAMES_PER_BATCH is ready.
      */
     bool processFrame(const AudioBuffer& buffer) {
-        AudioFrame* frame = &assembler_.packet.frames[assembler_.frameCount];
+        const uint32_t tFrame = telemetryCycles();
+
+        // Apply a pending rate change only between batches so every frame
+        // of a batch shares one sample_rate_code on the wire.
+        if (assembler_.frameCount == 0 && pendingRateCode_ != rateCode_) {
+            applyRateCode(pendingRateCode_);
+        }
+
+        // Same boundary rule for a downlinked headroom-scale change: one
+        // batch, one output gain.
+        if (assembler_.frameCount == 0 && pendingCleanScale_ != cleanScale_) {
+            Serial.printf("[Pipeline] clean scale %.2f -> %.2f\n",
+                          cleanScale_, pendingCleanScale_);
+            cleanScale_ = pendingCleanScale_;
+        }
+
+        // Take over a hot-swapped processor, also only between batches so
+        // a batch is never half staged under one wantsBatch() policy and
+        // sealed under another.  The retired pointer is parked for the
+        // control task to deinit (see swapProcessor()).
+        IAudioProcessor* incoming = pendingSwap_.load(std::memory_order_acquire);
+        if (incoming != nullptr && assembler_.frameCount == 0) {
+            Serial.printf("[Pipeline] processor '%s' -> '%s'\n",
+                          processor_->getName(), incoming->getName());
+            retired_.store(processor_, std::memory_order_release);
+            processor_ = incoming;
+            pendingSwap_.store(nullptr, std::memory_order_release);
+#ifdef PIPELINE_STATIC_PROCESSOR
+            staticBind_ = false;   // Swapped-in type is unknown -- go virtual
+#endif
+        }
+
+        // Backpressure relief engages at a batch boundary (same rule as
+        // swaps and rate changes: a batch is never half cheap, half real)
+        // and holds for RELIEF_HOLD_BATCHES so one engage clears a backlog
+        // rather than oscillating at the threshold.
+        if (reliefRequested_ && assembler_.frameCount == 0) {
+            reliefRequested_  = false;
+            if (reliefFramesLeft_ == 0) {
+                Serial.printf("[Pipeline] ring backlog -- bypassing '%s' "
+                              "for %d batches\n",
+                              processor_->getName(),
+                              Config::RELIEF_HOLD_BATCHES);
+                reliefEngaged_++;
+            }
+            reliefFramesLeft_ = Config::RELIEF_HOLD_BATCHES * framesPerBatch_;
+        }
+        // Latch per batch so a batch-depth change mid-hold can never leave
+        // a batch half relief, half staged-for-batch-inference.
+        if (assembler_.frameCount == 0) {
+            reliefBatch_ = (reliefFramesLeft_ > 0);
+        }
+
+        AudioFrame* frame = &assembler_.assembling().frames[assembler_.frameCount];
 
         // Populate frame header fields
         frame->frame_seq = buffer.sequence;
+        frame->channel   = buffer.channel;
+        frame->flags     = 0;
+
+        // Continuity check: stamp how many frames of this channel's stream
+        // went missing right before this one (queue overruns, idle gating).
+        // Unsigned arithmetic survives sequence wrap; the first frame of a
+        // stream has no predecessor and counts as contiguous.
+        const int chIdx = buffer.channel % Config::CAPTURE_CHANNELS;
+        uint32_t gap = 0;
+        if (seqValid_[chIdx]) {
+            gap = buffer.sequence - (lastSeq_[chIdx] + 1);
+        }
+        seqValid_[chIdx] = true;
+        lastSeq_[chIdx]  = buffer.sequence;
+        frame->gap_frames = (gap > 0xFFFF) ? 0xFFFF
+                                           : static_cast<uint16_t>(gap);
+        if (gap != 0) {
+            g_telemetry.gapEvents++;
+            g_telemetry.gapFramesLost += gap;
+        }
 
-        // Core inference step:
-        // processor_->processFrame() writes scaled output to frame->clean_pcm.
-        frame->vad_prob = processor_->processFrame(buffer.pcm, frame->clean_pcm);
+        // Decimation stage (16 kHz mode): one 480-sample capture frame
+        // becomes one 160-sample inference frame at the same 10 ms cadence.
+        // Everything downstream -- inference, RMS, the wire -- shrinks 3x.
+        // Each capture channel keeps its own FIR history -- interleaved
+        // streams through one decimator would corrupt both.
+        const int16_t* pcm = buffer.pcm;
+        uint64_t sumSq     = buffer.energySumSq;
+        if (rateCode_ == WIRE_RATE_16K) {
+            decimator_[buffer.channel % Config::CAPTURE_CHANNELS]
+                .process(decimated_, buffer.pcm, FRAME_SIZE);
+            pcm   = decimated_;
+            sumSq = dsp_sumsq_s16(pcm, frameSamples_);  // 160 MACs, not 480
+        }
+        const size_t pcmBytes = frameSamples_ * sizeof(int16_t);
+
+        if (reliefBatch_) {
+            // Relief path: the cheapest thing that is still valid audio --
+            // a copy plus the headroom scale, exactly what PassThrough
+            // would produce.  The real processor keeps its state and
+            // resumes untouched when the countdown ends.
+            if (reliefFramesLeft_ > 0) reliefFramesLeft_--;
+            applyScale(frame->clean_pcm, pcm, frameSamples_, cleanScale_);
+            frame->vad_prob = 0.99f;
+        } else if (processorWantsBatch()) {
+            // Batch-inference path: stage raw PCM contiguously and defer
+            // the model invocation until the batch is full (one invoke for
+            // the whole batch instead of frames_per_batch invokes).
+            memcpy(&rawStage_[assembler_.frameCount * frameSamples_],
+                   pcm, pcmBytes);
+            frame->vad_prob = 0.0f;   // Filled in after processBatch()
+        } else {
+            // Core inference step: processor_->processFrame() writes
+            // full-amplitude output; the headroom scale is applied once
+            // below, after the (possibly chained) processor has finished.
+            const uint32_t tInfer = telemetryCycles();
+            frame->vad_prob = invokeProcessor(pcm, frame->clean_pcm,
+                                              frameSamples_);
+            g_telemetry.stages[TSTAGE_INFERENCE].record(telemetryCycles() - tInfer);
+            applyScale(frame->clean_pcm, frame->clean_pcm, frameSamples_,
+                       cleanScale_);
+
+            // The only path with a per-frame primary VAD the shadow can
+            // diverge against; the input pointer stays valid until the
+            // caller releases the ring slot (runShadowFrame() runs first).
+            if (shadow_ != nullptr && buffer.channel == 0) {
+                shadowInput_      = pcm;
+                shadowPrimaryVad_ = frame->vad_prob;
+                shadowEligible_   = true;
+            }
+        }
 
-        // Metadata for telemetry / visualizer
-        frame->rms_raw = calculateRMS(buffer.pcm);
-        memcpy(frame->raw_pcm, buffer.pcm, sizeof(buffer.pcm));
+        // Metadata for telemetry / visualizer.  At the native rate the
+        // energy sum was already accumulated during the 32->16 conversion
+        // pass on Core 0, so RMS here is a division and one sqrtf -- no
+        // second pass over the PCM.
+        frame->rms_raw = rmsFromSumSq(sumSq, frameSamples_);
+        memcpy(frame->raw_pcm, pcm, pcmBytes);
 
         assembler_.frameCount++;
 
-        if (assembler_.frameCount >= FRAMES_PER_BATCH) {
+        bool ready = sealIfBatchComplete();
+        g_telemetry.stages[TSTAGE_FRAME_TOTAL].record(telemetryCycles() - tFrame);
+        return ready;
+    }
+
+    /**
+     * @brief Fillers to inject before this buffer (0 unless GAP_ZERO_FILL).
+     *
+     * Gaps wider than GAP_FILL_MAX -- low-power idle, long stalls -- are
+     * never filled; they get stamped into the next real frame instead.
+     * The caller injects via processFiller() BEFORE processFrame() so the
+     * filled timeline stays in capture order.
+     */
+    uint32_t fillerFramesNeeded(const AudioBuffer& buffer) const {
+        if (!Config::GAP_ZERO_FILL) return 0;
+        const int chIdx = buffer.channel % Config::CAPTURE_CHANNELS;
+        if (!seqValid_[chIdx]) return 0;
+        const uint32_t gap = buffer.sequence - (lastSeq_[chIdx] + 1);
+        return (gap >= 1 && gap <= Config::GAP_FILL_MAX) ? gap : 0;
+    }
+
+    /**
+     * @brief Inject one zero-PCM filler frame for a sequence hole.
+     *
+     * Takes the next slot in the assembling batch exactly like a real
+     * frame (including sealing -- same return contract as processFrame()),
+     * but never touches the processor: the PCM is silence by construction
+     * and the frame is flagged WIRE_FRAME_FLAG_FILLER so the server can
+     * tell synthetic audio from a genuinely quiet room.  Advances the
+     * channel's continuity state, so the following real frame stamps
+     * gap_frames = 0: the timeline is whole again.
+     *
+     * @param channel  Capture channel whose stream is being repaired.
+     * @return         true when this filler sealed a batch (caller must
+     *                 collect it via getBatch() before injecting more).
+     */
+    bool processFiller(uint8_t channel) {
+        // Same per-batch latch as processFrame() -- a filler can open a
+        // batch, and that batch must pick one processing policy.
+        if (assembler_.frameCount == 0) {
+            reliefBatch_ = (reliefFramesLeft_ > 0);
+        }
+
+        AudioFrame* frame = &assembler_.assembling().frames[assembler_.frameCount];
+        const int chIdx = channel % Config::CAPTURE_CHANNELS;
+
+        frame->frame_seq  = ++lastSeq_[chIdx];
+        frame->channel    = channel;
+        frame->flags      = WIRE_FRAME_FLAG_FILLER;
+        frame->gap_frames = 0;
+        frame->vad_prob   = 0.0f;
+        frame->rms_raw    = 0.0f;
+
+        const size_t pcmBytes = frameSamples_ * sizeof(int16_t);
+        memset(frame->raw_pcm,   0, pcmBytes);
+        memset(frame->clean_pcm, 0, pcmBytes);
+        if (!reliefBatch_ && processorWantsBatch()) {
+            // The batch path runs inference over rawStage_ at seal time --
+            // the filler's slice must be silence there too, or the model
+            // would denoise whatever the previous batch left behind.
+            memset(&rawStage_[assembler_.frameCount * frameSamples_],
+                   0, pcmBytes);
+        }
+
+        g_telemetry.fillerFrames++;
+        assembler_.frameCount++;
+        return sealIfBatchComplete();
+    }
+
+private:
+    /** @brief Seal and rotate when the active batch is full.
+     *  @return true when a completed batch awaits transmission. */
+    bool sealIfBatchComplete() {
+        if (assembler_.frameCount >= framesPerBatch_) {
+            if (processorWantsBatch() && !reliefBatch_) {
+                runBatchInference();
+            }
             finalizeBatch();
-            return true;   // Caller should transmit immediately
+
+            if (assembler_.allOthersInFlight()) {
+                // Every other buffer is still transmitting -- recycle the
+                // active buffer in place and drop this batch rather than
+                // stall inference behind the network.
+                batchesOverwritten_++;
+                assembler_.reset();
+                return false;
+            }
+
+            completed_ = &assembler_.assembling();
+            assembler_.inFlight.fetch_add(1, std::memory_order_release);
+            assembler_.active = (assembler_.active + 1) % Config::BATCH_BUFFERS;
+            assembler_.reset();
+            return true;   // Caller owns the completed batch until releaseBatch()
         }
         return false;
     }
 
-    /** @brief Const access to the completed batch (valid only when processFrame returns true). */
-    const BatchPacket* getBatch() const { return &assembler_.packet; }
+public:
+    /** @brief The completed batch (valid only after processFrame returned true,
+     *         until releaseBatch() hands the buffer back to the pool). */
+    const BatchPacket* getBatch() const { return completed_; }
+
+    /**
+     * @brief Return a transmitted (or abandoned) batch buffer to the pool.
+     *
+     * Must be called exactly once per true return from processFrame(),
+     * after the transmit side is finished reading the packet.
+     */
+    void releaseBatch(const BatchPacket* /*batch*/) {
+        assembler_.inFlight.fetch_sub(1, std::memory_order_release);
+    }
+
+    /** @brief Batches dropped because every buffer was still in flight. */
+    uint32_t batchesOverwritten() const { return batchesOverwritten_; }
+
+    /**
+     * @brief Forget per-stream state after an out-of-band run.
+     *
+     * The replay harness (replay.h) pushes its own sequence stream
+     * through the pipeline at boot; this drops any partially assembled
+     * batch and the continuity history so the first live capture frame
+     * opens a fresh stream instead of stamping a bogus gap against the
+     * replay's sequence numbers.  Call only while nothing else touches
+     * the pipeline -- in practice, from setup() before the tasks exist.
+     */
+    void resetStreamState() {
+        assembler_.reset();
+        for (int c = 0; c < Config::CAPTURE_CHANNELS; c++) {
+            seqValid_[c] = false;
+        }
+    }
+
+    /**
+     * @brief Change the batching depth (latency/throughput profile).
+     *
+     * Takes effect immediately: if the active batch already holds at least
+     * `n` frames it is sealed on the next processFrame() call.  Call only
+     * from the processing task (or before the tasks start) -- assembly
+     * state is single-owner by design.
+     *
+     * @param n  Frames per batch, clamped to [1, FRAMES_PER_BATCH_MAX].
+     */
+    void setFramesPerBatch(uint8_t n) {
+        if (n < 1)                    n = 1;
+        if (n > FRAMES_PER_BATCH_MAX) n = FRAMES_PER_BATCH_MAX;
+        if (n != framesPerBatch_) {
+            Serial.printf("[Pipeline] frames_per_batch %u -> %u\n",
+                          framesPerBatch_, n);
+            framesPerBatch_ = n;
+        }
+    }
+
+    /** @brief Current batching depth. */
+    uint8_t framesPerBatch() const { return framesPerBatch_; }
+
+    /**
+     * @brief Request a capture-rate change (WIRE_RATE_48K / WIRE_RATE_16K).
+     *
+     * Deferred to the next batch boundary so a batch never mixes rates.
+     * Call only from the processing task (same ownership rule as
+     * setFramesPerBatch()).
+     */
+    void setSampleRateCode(uint8_t code) {
+        if (code != WIRE_RATE_48K && code != WIRE_RATE_16K) return;
+        pendingRateCode_ = code;
+    }
+
+    /**
+     * @brief Stage a headroom-scale change (downlink runtime tuning).
+     *
+     * Clamped to [0.25, 1.0]: below that the int16 stream loses too many
+     * bits to be useful, above 1.0 the visualizer headroom guarantee dies.
+     * Applied at the next batch boundary; same ownership rule as the other
+     * setters (processing task only).
+     */
+    void setCleanScale(float scale) {
+        if (scale < 0.25f) scale = 0.25f;
+        if (scale > 1.0f)  scale = 1.0f;
+        pendingCleanScale_ = scale;
+    }
+
+    /** @brief Headroom scale currently applied to clean_pcm. */
+    float cleanScale() const { return cleanScale_; }
+
+    /** @brief Currently active rate code. */
+    uint8_t sampleRateCode() const { return rateCode_; }
+
+    /**
+     * @brief Ask for backpressure relief (frame-ring backlog building).
+     *
+     * Called by the processing task when the ring crosses the watermark
+     * threshold; the pipeline engages (or extends) the cheap bypass path
+     * at the next batch boundary.  Same single-owner rule as the other
+     * processing-task-only entry points.
+     */
+    void requestRelief() { reliefRequested_ = true; }
+
+    /** @brief Times the relief path engaged (stats line). */
+    uint32_t reliefEngagements() const { return reliefEngaged_; }
+
+    /** @brief Forward to the processor's stats hook (per-stage timings for
+     *         chains, nothing for simple processors).  Stats path only. */
+    void printProcessorStats() const {
+        if (processor_ != nullptr) processor_->printStats();
+    }
+
+    /**
+     * @brief Attach a shadow processor for in-situ A/B evaluation.
+     *
+     * The shadow runs opportunistically on the same input as the primary
+     * (see runShadowFrame()); its output never reaches the wire, only the
+     * comparison stats do.  This answers "does the candidate meet the
+     * 10 ms budget on REAL fleet audio, and does its VAD agree with the
+     * incumbent" without flashing away the baseline.
+     *
+     * Call from setup() before the tasks start -- attachment is not
+     * synchronized against a running processing task (use swapProcessor()
+     * if the candidate should actually go live).
+     *
+     * @return true if the shadow initialized and is attached.
+     */
+    bool attachShadow(IAudioProcessor* shadow) {
+        if (shadow == nullptr || shadow == processor_) return false;
+        if (!shadow->init()) {
+            Serial.printf("[Pipeline] shadow '%s' init failed -- not attached\n",
+                          shadow->getName());
+            return false;
+        }
+        shadowHist_.reset();
+        shadowVadSum_  = 0.0f;
+        shadowVadMax_  = 0.0f;
+        shadowRun_     = 0;
+        shadowSkipped_ = 0;
+        shadow_ = shadow;
+        Serial.printf("[Pipeline] shadow '%s' attached\n", shadow->getName());
+        return true;
+    }
+
+    /**
+     * @brief Opportunistically run the shadow on the frame just processed.
+     *
+     * Called by the processing task AFTER processFrame(), with idleBudget
+     * telling it whether the frame ring is empty -- the shadow only spends
+     * cycles Core 1 genuinely has spare, and skipped frames are counted so
+     * the report shows how representative the sample is.  Only per-frame
+     * inference frames on channel 0 are eligible: relief and batch-staged
+     * frames have no comparable per-frame primary VAD, and a stateful
+     * shadow would corrupt itself on interleaved channel streams.
+     */
+    void runShadowFrame(bool idleBudget) {
+        if (shadow_ == nullptr || !shadowEligible_) return;
+        shadowEligible_ = false;
+        if (!idleBudget) {
+            shadowSkipped_++;
+            return;
+        }
+        const uint32_t t0 = telemetryCycles();
+        const float vad = shadow_->processFrame(shadowInput_, shadowOut_,
+                                                frameSamples_);
+        shadowHist_.record(telemetryCycles() - t0);
+        const float d = fabsf(vad - shadowPrimaryVad_);
+        shadowVadSum_ += d;
+        if (d > shadowVadMax_) shadowVadMax_ = d;
+        shadowRun_++;
+    }
+
+    /** @brief Comparison report: shadow cycle cost vs the frame budget and
+     *         VAD divergence against the primary.  Stats path only. */
+    void printShadowStats() const {
+        if (shadow_ == nullptr || shadowRun_ == 0) return;
+        constexpr uint32_t budgetCyc = 10000 * TELEMETRY_CYCLES_PER_US;
+        const uint32_t p99 = shadowHist_.percentileCycles(99);
+        Serial.printf("[Stats]   shadow '%s': p50=%6luus  p99=%6luus "
+                      "(%lu%% of budget)  n=%lu skipped=%lu\n",
+                      shadow_->getName(),
+                      shadowHist_.percentileUs(50),
+                      shadowHist_.percentileUs(99),
+                      static_cast<unsigned long>((100ull * p99) / budgetCyc),
+                      static_cast<unsigned long>(shadowRun_),
+                      static_cast<unsigned long>(shadowSkipped_));
+        Serial.printf("[Stats]   shadow vad divergence: mean=%.3f max=%.3f\n",
+                      shadowVadSum_ / shadowRun_, shadowVadMax_);
+    }
+
+    /**
+     * @brief Replace the active processor at runtime, without a reboot.
+     *
+     * Field A/B experiments used to cost a reboot (~15 s of WiFi re-join
+     * and downtime) per model change.  Sequence here: the NEW processor is
+     * fully initialized first -- on this task, while audio keeps flowing
+     * through the old one -- then handed to the processing task, which
+     * adopts it at the next batch boundary.  The old processor is deinited
+     * here once the handoff is confirmed, so its arena goes back to
+     * g_arenaPool only after its last frame.
+     *
+     * Call from the control task (loop()) only -- NEVER from the
+     * processing task (it would deadlock waiting for itself).
+     *
+     * @param next  Initialized-on-demand replacement processor.
+     * @return      true once the swap completed and the old processor was
+     *              retired; false if init() failed or frames are not
+     *              flowing (swap withdrawn, old processor still active).
+     */
+    bool swapProcessor(IAudioProcessor* next) {
+        if (next == nullptr || next == processor_) return false;
+        if (pendingSwap_.load(std::memory_order_acquire) != nullptr) {
+            Serial.println("[Pipeline] Swap already in flight -- rejected");
+            return false;
+        }
+
+        if (!next->init()) {
+            Serial.printf("[Pipeline] '%s' init failed -- keeping '%s'\n",
+                          next->getName(), processor_->getName());
+            return false;
+        }
+
+        pendingSwap_.store(next, std::memory_order_release);
+
+        // Wait for the processing task to adopt it at a batch boundary;
+        // worst case is one full batch (FRAMES_PER_BATCH_MAX frames).
+        for (int i = 0; i < 2 * FRAMES_PER_BATCH_MAX; i++) {
+            if (pendingSwap_.load(std::memory_order_acquire) == nullptr) break;
+            vTaskDelay(pdMS_TO_TICKS(FRAME_DURATION_US / 1000));
+        }
+
+        // Withdraw-or-confirm: if the pending pointer is still ours the
+        // processing task never ran (capture stalled?) -- roll back.
+        if (pendingSwap_.exchange(nullptr, std::memory_order_acq_rel) != nullptr) {
+            Serial.println("[Pipeline] Swap timed out -- rolled back");
+            next->deinit();
+            return false;
+        }
 
-    /** @brief Reset assembler after successful transmission. */
-    void markTransmitted() { assembler_.reset(); }
+        IAudioProcessor* old = retired_.exchange(nullptr,
+                                                 std::memory_order_acq_rel);
+        if (old != nullptr) old->deinit();
+        Serial.printf("[Pipeline] Running with processor: %s\n",
+                      processor_->getName());
+        return true;
+    }
 
 private:
+    /**
+     * @brief Inference dispatch: statically bound when the build allows it.
+     *
+     * A qualified call through the concrete type compiles to a direct,
+     * inlinable call -- no vtable load, no indirect branch -- which is
+     * what lets the compiler fuse e.g. PassThrough's memcpy with the Q15
+     * scale that follows.  The staticBind_ flag (one predictable branch)
+     * demotes to the virtual path whenever processor_ might not be the
+     * bound type; builds without PIPELINE_STATIC_PROCESSOR compile to the
+     * plain virtual call with zero overhead added.
+     */
+    inline float invokeProcessor(const int16_t* in, int16_t* out, int n) {
+#ifdef PIPELINE_STATIC_PROCESSOR
+        if (staticBind_) {
+            return static_cast<PIPELINE_STATIC_PROCESSOR*>(processor_)
+                       ->PIPELINE_STATIC_PROCESSOR::processFrame(in, out, n);
+        }
+#endif
+        return processor_->processFrame(in, out, n);
+    }
+
+    /** @brief Same dispatch rule for the batch-policy query. */
+    inline bool processorWantsBatch() const {
+#ifdef PIPELINE_STATIC_PROCESSOR
+        if (staticBind_) {
+            return static_cast<PIPELINE_STATIC_PROCESSOR*>(processor_)
+                       ->PIPELINE_STATIC_PROCESSOR::wantsBatch();
+        }
+#endif
+        return processor_->wantsBatch();
+    }
+
+    /** @brief Same dispatch rule for batched inference. */
+    inline void invokeProcessorBatch(const int16_t* in, int16_t* out,
+                                     float* vadOut, int nFrames,
+                                     int frameSamples) {
+#ifdef PIPELINE_STATIC_PROCESSOR
+        if (staticBind_) {
+            static_cast<PIPELINE_STATIC_PROCESSOR*>(processor_)
+                ->PIPELINE_STATIC_PROCESSOR::processBatch(in, out, vadOut,
+                                                          nFrames, frameSamples);
+            return;
+        }
+#endif
+        processor_->processBatch(in, out, vadOut, nFrames, frameSamples);
+    }
+
     /**
      * @brief Seal the batch header before transmission.
      */
+    /**
+     * @brief Batch-inference step: one processBatch() over the staged raw
+     *        PCM, then scatter clean frames and VAD back into the packet.
+     *
+     * The wire format interleaves per-frame headers with PCM, so the
+     * contiguous in/out buffers models want cost one extra copy per
+     * direction.  That is the explicit trade: two memcpys buy one
+     * interpreter invoke per batch instead of per frame.
+     */
+    void runBatchInference() {
+        const int n = assembler_.frameCount;
+        const uint32_t tInfer = telemetryCycles();
+        invokeProcessorBatch(rawStage_, cleanStage_, vadStage_, n,
+                             frameSamples_);
+        g_telemetry.stages[TSTAGE_INFERENCE].record(telemetryCycles() - tInfer);
+
+        BatchPacket& packet = assembler_.assembling();
+        for (int f = 0; f < n; f++) {
+            // Scatter doubles as the single headroom-scale application --
+            // the scaled copy replaces what used to be a memcpy + scale.
+            applyScale(packet.frames[f].clean_pcm,
+                       &cleanStage_[f * frameSamples_],
+                       frameSamples_, cleanScale_);
+            packet.frames[f].vad_prob = vadStage_[f];
+        }
+    }
+
+    /** @brief Switch the active rate at a batch boundary. */
+    void applyRateCode(uint8_t code) {
+        rateCode_     = code;
+        frameSamples_ = WIRE_FRAME_SAMPLES(code);
+        // Never carry history across a rate switch
+        for (int ch = 0; ch < Config::CAPTURE_CHANNELS; ch++) {
+            decimator_[ch].reset();
+        }
+        Serial.printf("[Pipeline] sample rate -> %s (%d samples/frame)\n",
+                      code == WIRE_RATE_16K ? "16 kHz" : "48 kHz",
+                      frameSamples_);
+    }
+
     void finalizeBatch() {
-        BatchHeader& hdr   = assembler_.packet.header;
+        BatchHeader& hdr   = assembler_.assembling().header;
         hdr.magic          = PROTOCOL_MAGIC;
         hdr.version        = PROTOCOL_VERSION;
-        hdr.reserved[0]    = 0x00;
-        hdr.reserved[1]    = 0x00;
+        hdr.reserved[0]    = assembler_.frameCount;  // Frames in this batch
+        hdr.reserved[1]    = rateCode_;              // Rate for every frame
         hdr.reserved[2]    = 0x00;
         hdr.batch_seq      = assembler_.batchSequence++;
         // timestamp_ms: ms since ESP32 boot (NOT Unix time -- Design Doc v1.2 sec.2)
@@ -434,21 +1437,94 @@ private:
 
     /**
      * @brief Compute Root-Mean-Square of a PCM frame for the rms_raw field.
+     *
+     * Uses the integer energy kernel (dsp_sumsq_s16) -- 480 float
+     * multiply-adds replaced by int32 MACs into a uint64, with a single
+     * sqrtf at the end.  The hot path normally avoids even this by using
+     * the energy pre-accumulated in AudioBuffer::energySumSq.
+     *
      * @param pcm  Input buffer, FRAME_SIZE samples.
      * @return     RMS as a float.
      */
     static float calculateRMS(const int16_t* pcm) {
-        float sum = 0.0f;
-        for (int i = 0; i < FRAME_SIZE; ++i) {
-            float s = static_cast<float>(pcm[i]);
-            sum += s * s;
-        }
-        return sqrtf(sum / FRAME_SIZE);
+        return rmsFromSumSq(dsp_sumsq_s16(pcm, FRAME_SIZE), FRAME_SIZE);
     }
 
-    IAudioProcessor* processor_;   ///< Pluggable inference strategy
-    QueueHandle_t    queue_;       ///< Reference to inter-task audio queue
-    BatchAssembler   assembler_;   ///< Batch accumulation state
+    /** @brief RMS from a pre-accumulated sum of squares over `n` samples. */
+    static float rmsFromSumSq(uint64_t sumSq, int n) {
+        return sqrtf(static_cast<float>(sumSq) / n);
+    }
+
+    IAudioProcessor*   processor_;           ///< Pluggable inference strategy
+    ProcessorChain     chain_;               ///< Backing for the array begin()
+    BatchAssembler     assembler_;           ///< Batch accumulation state
+
+    // Hot-swap handoff (control task <-> processing task, see
+    // swapProcessor()).  pendingSwap_: initialized replacement awaiting
+    // adoption; retired_: previous processor awaiting deinit.
+    std::atomic<IAudioProcessor*> pendingSwap_{nullptr};
+    std::atomic<IAudioProcessor*> retired_{nullptr};
+    const BatchPacket* completed_ = nullptr; ///< Last sealed batch (in flight)
+    uint32_t           batchesOverwritten_ = 0; ///< Dropped: no free buffer
+    uint8_t            framesPerBatch_ = FRAMES_PER_BATCH; ///< Session depth
+
+#ifdef PIPELINE_STATIC_PROCESSOR
+    // True while processor_ is known to be the statically bound type --
+    // cleared by the init-failure fallback and by hot swaps, after which
+    // dispatch goes through the vtable like a dev build.
+    bool staticBind_ = false;
+#endif
+
+    // Sequence-continuity state, one slot per capture channel (frames of
+    // different channels interleave through the ring but each channel's
+    // sequence stream is independently contiguous).
+    uint32_t lastSeq_[Config::CAPTURE_CHANNELS]  = {0};
+    bool     seqValid_[Config::CAPTURE_CHANNELS] = {false};
+
+    // Backpressure relief state (processing task only, see requestRelief())
+    bool     reliefRequested_  = false;  ///< Engage at next batch boundary
+    bool     reliefBatch_      = false;  ///< Current batch takes the bypass
+    int      reliefFramesLeft_ = 0;      ///< Frames until normal inference
+    uint32_t reliefEngaged_    = 0;      ///< Engagement count (stats)
+
+    // Shadow-mode A/B evaluation state (processing task only, except the
+    // setup-time attach).  The eligibility trio is a one-frame handoff
+    // from processFrame() to runShadowFrame(); the output buffer exists
+    // only so the shadow has somewhere to write -- it is never read.
+    IAudioProcessor* shadow_        = nullptr;
+    const int16_t*   shadowInput_   = nullptr;
+    float     shadowPrimaryVad_ = 0.0f;
+    bool      shadowEligible_   = false;
+    int16_t   shadowOut_[FRAME_SIZE];
+    CycleHist shadowHist_;               ///< Shadow processFrame() cost
+    float     shadowVadSum_     = 0.0f;  ///< Sum of |vad_shadow - vad_primary|
+    float     shadowVadMax_     = 0.0f;
+    uint32_t  shadowRun_        = 0;     ///< Frames the shadow actually ran
+    uint32_t  shadowSkipped_    = 0;     ///< Eligible frames skipped (behind)
+
+    // Decimation stage (16 kHz mode).  rateCode_/frameSamples_ are the
+    // active values; pendingRateCode_ buffers a downlinked change until
+    // the next batch boundary.  One decimator per capture channel -- FIR
+    // history is per-stream state.
+    Decimator3x decimator_[Config::CAPTURE_CHANNELS];
+    int16_t     decimated_[FRAME_SIZE_16K];
+    uint8_t     rateCode_        = WIRE_RATE_48K;
+    uint8_t     pendingRateCode_ = WIRE_RATE_48K;
+    int         frameSamples_    = FRAME_SIZE;
+
+    // Clean-stream headroom scale.  cleanScale_ is the active value;
+    // pendingCleanScale_ buffers a downlinked change until the next batch
+    // boundary (same deferral rule as the rate code -- a mid-batch change
+    // would put two gain levels inside one batch).
+    float cleanScale_        = CLEAN_PCM_SCALE;
+    float pendingCleanScale_ = CLEAN_PCM_SCALE;
+
+    // Contiguous staging for the batch-inference path (processors that
+    // return wantsBatch() == true).  ~15 KB each at max depth -- static
+    // like every other runtime buffer, sized once for the worst case.
+    int16_t rawStage_[FRAMES_PER_BATCH_MAX * FRAME_SIZE];
+    int16_t cleanStage_[FRAMES_PER_BATCH_MAX * FRAME_SIZE];
+    float   vadStage_[FRAMES_PER_BATCH_MAX];
 };
 
 // ============================================================================
@@ -474,11 +1550,16 @@ public:
             .mode                 = static_cast<i2s_mode_t>(I2S_MODE_MASTER | I2S_MODE_RX),
             .sample_rate          = SAMPLE_RATE,                 // 48 000 Hz
             .bits_per_sample      = I2S_BITS_PER_SAMPLE_32BIT,  // BCLK = 64 x WS (REQUIRED)
-            .channel_format       = I2S_CHANNEL_FMT_ONLY_LEFT,
+            // Dual-mic units put a second INMP441 on the same bus with its
+            // L/R select tied high; stereo slots then carry both mics and
+            // the conversion kernel deinterleaves them for free.
+            .channel_format       = (Config::CAPTURE_CHANNELS == 2)
+                                        ? I2S_CHANNEL_FMT_RIGHT_LEFT
+                                        : I2S_CHANNEL_FMT_ONLY_LEFT,
             .communication_format = I2S_COMM_FORMAT_STAND_I2S,
             .intr_alloc_flags     = ESP_INTR_FLAG_LEVEL1,
             .dma_buf_count        = 8,
-            .dma_buf_len          = FRAME_SIZE,                  // 480 samples per DMA buffer
+            .dma_buf_len          = FRAME_SIZE,                  // 480 samples/channel per DMA buffer
             .use_apll             = true,    // Required for 48 kHz accuracy
             .tx_desc_auto_clear   = false,
             .fixed_mclk           = 0
@@ -491,11 +1572,22 @@ public:
             .data_in_num  = Config::I2S_SD
         };
 
-        esp_err_t err = i2s_driver_install(I2S_NUM_0, &config, 0, NULL);
+        // Install WITH an event queue: the capture task sleeps on it and
+        // wakes exactly when a DMA buffer completes, instead of spinning
+        // in a blocking read with a 100 ms timeout.  The queue also makes
+        // RX overflow events visible -- before this they were silent data
+        // corruption.
+        esp_err_t err = i2s_driver_install(I2S_NUM_0, &config,
+                                           Config::I2S_EVENT_QUEUE_LEN,
+                                           &eventQueue_);
         if (err != ESP_OK) {
             Serial.printf("[I2S] Driver install failed: %d\n", err);
             return false;
         }
+        if (eventQueue_ == nullptr) {
+            Serial.println("[I2S] Event queue creation failed");
+            return false;
+        }
 
         err = i2s_set_pin(I2S_NUM_0, &pins);
         if (err != ESP_OK) {
@@ -537,38 +1629,234 @@ public:
         }
 
         // Convert 32-bit I2S data to 16-bit PCM
-        // INMP441 provides 24-bit data in high 24 bits of 32-bit slot
-        // We take the high 16 bits (bits 31:16) of each 32-bit sample
+        // INMP441 provides 24-bit data in high 24 bits of 32-bit slot;
+        // the kernel extracts the high 16 bits (bits 31:16) of each sample.
         int samplesRead = bytesRead / sizeof(int32_t);
         if (samplesRead > FRAME_SIZE) samplesRead = FRAME_SIZE;
 
-        for (int i = 0; i < samplesRead; i++) {
-            // Extract high 16 bits: shift right by 16
-            // This preserves the sign and gives us the upper 16 bits of the 24-bit data
-            buffer[i] = static_cast<int16_t>(dmaBuffer[i] >> 16);
-        }
+        dsp_convert32to16(buffer, dmaBuffer, samplesRead);
 
         return samplesRead * sizeof(int16_t);
     }
 
+    /**
+     * @brief Blocking read of up to `nFrames` frame times in one i2s_read().
+     *
+     * Batched variant of read() for the capture hot path: one driver call
+     * (one syscall-ish trip through the ESP-IDF I2S layer, one scheduler
+     * wakeup) delivers several frames, and the 32->16-bit conversion loop
+     * runs over a longer, cache-friendlier span.  Each frame is converted
+     * directly into its caller-owned destination -- typically a FrameRing
+     * slot -- so no staging copy is added back.
+     *
+     * In dual-mic builds every frame time yields CAPTURE_CHANNELS frames:
+     * the DMA stream is L/R interleaved and the stereo conversion kernel
+     * deinterleaves inside the same pass that extracts the high 16 bits
+     * and accumulates per-channel energy.
+     *
+     * @param dst        Array of `nFrames * CAPTURE_CHANNELS` destination
+     *                   pointers ordered [frame time][channel], each holding
+     *                   FRAME_SIZE int16 samples.  Entries may alias (e.g. a
+     *                   shared discard buffer when the ring is full).
+     * @param sumSq      Out: per-destination sum of squared samples, same
+     *                   ordering -- computed for free inside the conversion
+     *                   pass (see dsp_convert32to16_sumsq).
+     * @param nFrames    Frame times to read (1..Config::CAPTURE_FRAMES_MAX).
+     * @param timeoutMs  Maximum wait time in milliseconds for the whole read.
+     * @return           Number of COMPLETE frame times delivered (0 on
+     *                   error / timeout; a short read yields only the full
+     *                   frame times).
+     */
+    /**
+     * @brief Sleep until DMA has at least one frame ready.
+     *
+     * Blocks on the driver's event queue for the first RX_DONE, then
+     * drains whatever else is already queued without blocking, so the
+     * caller learns exactly how many frames a single readFrames() can
+     * fetch.  RX overflow events (DMA wrote over unread data because we
+     * were late) are counted into telemetry instead of being dropped on
+     * the floor.
+     *
+     * @param maxFrames     Upper bound on the reported backlog
+     *                      (<= Config::CAPTURE_FRAMES_MAX).
+     * @param timeoutTicks  Wait limit for the FIRST event.
+     * @return              DMA buffers ready to read (0 on timeout or if
+     *                      only overflow events arrived).
+     */
+    int waitFrames(int maxFrames, TickType_t timeoutTicks) {
+        i2s_event_t evt;
+        if (xQueueReceive(eventQueue_, &evt, timeoutTicks) != pdTRUE) {
+            return 0;
+        }
+
+        int ready = 0;
+        do {
+            if (evt.type == I2S_EVENT_RX_DONE) {
+                ready++;
+            } else if (evt.type == I2S_EVENT_RX_Q_OVF) {
+                g_telemetry.dmaOverruns++;
+            }
+        } while (ready < maxFrames &&
+                 xQueueReceive(eventQueue_, &evt, 0) == pdTRUE);
+
+        return ready;
+    }
+
+    int readFrames(int16_t* const* dst, uint64_t* sumSq, int nFrames,
+                   size_t timeoutMs) {
+        // Static: Config::CAPTURE_FRAMES_MAX frame times of 32-bit samples
+        // (x channels) stay off the capture task's 4 KB stack.
+        static int32_t dmaBuffer[Config::CAPTURE_FRAMES_MAX *
+                                 Config::CAPTURE_CHANNELS * FRAME_SIZE];
+
+        if (nFrames < 1) nFrames = 1;
+        if (nFrames > Config::CAPTURE_FRAMES_MAX) nFrames = Config::CAPTURE_FRAMES_MAX;
+
+        const size_t wordsPerFrameTime = FRAME_SIZE * Config::CAPTURE_CHANNELS;
+
+        size_t bytesRead = 0;
+        esp_err_t err = i2s_read(I2S_NUM_0,
+                                 dmaBuffer,
+                                 sizeof(int32_t) * wordsPerFrameTime * nFrames,
+                                 &bytesRead,
+                                 pdMS_TO_TICKS(timeoutMs));
+
+        if (err != ESP_OK || bytesRead == 0) {
+            return 0;
+        }
+
+        int framesRead = bytesRead / (sizeof(int32_t) * wordsPerFrameTime);
+
+        for (int f = 0; f < framesRead; f++) {
+            // Same 24-bit-in-32-bit extraction as read(), fused with the
+            // energy accumulation that feeds rms_raw -- one pass, not two.
+            // The stereo variant also deinterleaves L/R in that one pass.
+            const int32_t* src = &dmaBuffer[f * wordsPerFrameTime];
+            if (Config::CAPTURE_CHANNELS == 2) {
+                dsp_convert32to16_sumsq_2ch(dst[2 * f], dst[2 * f + 1], src,
+                                            FRAME_SIZE,
+                                            &sumSq[2 * f], &sumSq[2 * f + 1]);
+            } else {
+                sumSq[f] = dsp_convert32to16_sumsq(dst[f], src, FRAME_SIZE);
+            }
+        }
+
+        return framesRead;
+    }
+
 private:
-    // No private members needed - using static local buffer in read()
+    QueueHandle_t eventQueue_ = nullptr;   ///< DMA events from the driver
 };
 
 // ============================================================================
 // NETWORK MANAGER: WebSocket client
 // ============================================================================
 
+// Batch-depth change requested over the downlink (0 = none pending).
+// Written by the WebSocket event callback, consumed by taskAudioProcessing
+// between frames so the depth only ever changes at a frame boundary.
+static volatile uint8_t g_pendingBatchFrames = 0;
+
+// Sample-rate change requested over the downlink (0xFF = none pending --
+// 0x00 is a valid code).  Same staging pattern as g_pendingBatchFrames;
+// the pipeline additionally defers the switch to a batch boundary.
+static volatile uint8_t g_pendingRateCode = 0xFF;
+
+// VAD transmission gate, off until the server opts in via
+// WIRE_CTRL_SET_VAD_GATE.  Read by the sender task per batch -- no
+// boundary staging needed because the gate only changes which batches go
+// on the wire, never how they are assembled.
+static volatile bool g_vadGateEnabled = false;
+
+// Runtime-tunable VAD gate thresholds (WIRE_CTRL_SET_GATE_THRESH).  The
+// Config values are the boot defaults; a 32-bit aligned float store is
+// atomic on this core, and the sender task reads them once per batch, so
+// no staging is needed.
+static volatile float g_gateVadThresh = Config::GATE_VAD_THRESH;
+static volatile float g_gateRmsFloor  = Config::GATE_RMS_FLOOR;
+
+// Headroom-scale change requested over the downlink (0 = none pending,
+// value in Q15).  Staged like the rate code; the pipeline applies it at a
+// batch boundary so one batch never mixes two output gains.
+static volatile uint16_t g_pendingCleanScaleQ15 = 0;
+
+// Processor swap requested over the downlink (0xFF = none pending, else
+// WIRE_PROC_*).  Consumed by loop() -- swapProcessor() is control-task-only
+// and can block for a batch, which a WS callback must never do.
+static volatile uint8_t g_pendingProcessorId = 0xFF;
+
+// Low-power idle request (battery builds, Config::POWER_SAVE_ENABLE).
+// Set by the sender task after POWER_IDLE_AFTER_BATCHES consecutive
+// gate-suppressed batches; consumed and cleared by the capture task, which
+// owns entry/exit because only it can wake within one frame of energy.
+static volatile bool g_powerIdleRequested = false;
+
 /**
  * @class WebSocketManager
  * @brief Manages the WebSocket connection to the Python bridge server.
  *
- * Sends fully assembled BatchPacket blobs (7744 bytes) as binary frames.
+ * Encodes completed batches into the v2 wire format (protocol_schema.h)
+ * with the per-connection payload mode and sends them as binary frames.
  * Reconnects automatically every 5 s on disconnection.
+ *
+ * TRANSPORT:
+ *   Built on the ESP-IDF native esp_websocket_client when available --
+ *   fully event-driven, the client runs its own task and sends complete
+ *   without the main loop's involvement, so batch delivery no longer
+ *   picks up the millisecond-granular jitter of pumping ws_.loop() from
+ *   loop()/delay(1).  Builds without the component (plain Arduino
+ *   framework) transparently fall back to the polled WebSocketsClient;
+ *   loop() is a no-op under the native client.
+ *
+ * PAYLOAD MODE NEGOTIATION:
+ *   The ESP always starts (and restarts after every reconnect) in
+ *   WIRE_PAYLOAD_FULL.  The server may downlink a 2-byte binary message
+ *   { WIRE_CTRL_SET_PAYLOAD_MODE, mode } to switch this connection to
+ *   CLEAN_ONLY or RAW_DELTA8 and cut wire size by 50 / 25 %.  The switch
+ *   takes effect at the next batch boundary -- modes never change inside
+ *   a message.
  */
 class WebSocketManager {
 public:
+#if WS_NATIVE_CLIENT
     void begin() {
+        esp_websocket_client_config_t cfg = {};
+        cfg.host                 = Config::WS_HOST;
+        cfg.port                 = Config::WS_PORT;
+        cfg.path                 = Config::WS_PATH;
+        cfg.transport            = WEBSOCKET_TRANSPORT_OVER_TCP;
+        cfg.reconnect_timeout_ms = 5000;    // Match the old client's cadence
+        cfg.ping_interval_sec    = 15;      // ...and its heartbeat
+
+        client_ = esp_websocket_client_init(&cfg);
+        if (client_ == nullptr) {
+            Serial.println("[WS] Native client init failed");
+            return;
+        }
+        esp_websocket_register_events(client_, WEBSOCKET_EVENT_ANY,
+                                      eventHandler, this);
+        esp_websocket_client_start(client_);
+        Serial.printf("[WS] Connecting to ws://%s:%d%s (native client)\n",
+                      Config::WS_HOST, Config::WS_PORT, Config::WS_PATH);
+    }
+
+    /** @brief No-op: the native client services itself from its own task. */
+    void loop() {}
+
+    bool isConnected() {
+        return client_ != nullptr && esp_websocket_client_is_connected(client_);
+    }
+#else
+    void begin() {
+        // WebSocketsClient is not thread-safe, and this client is touched
+        // from two tasks: the sender (sendBatch/sendSilenceMarker) and the
+        // loop task (ws_.loop() pumping, telemetry, control ACKs).  One
+        // recursive mutex serializes every entry -- recursive because an
+        // ACK is sent from handleControl() while loop() already holds it.
+        lock_ = xSemaphoreCreateRecursiveMutex();
+        ws_.onEvent([this](WStype_t type, uint8_t* payload, size_t length) {
+            onEvent(type, payload, length);
+        });
         ws_.begin(Config::WS_HOST, Config::WS_PORT, Config::WS_PATH);
         ws_.setReconnectInterval(5000);
         ws_.enableHeartbeat(15000, 3000, 2);
@@ -576,27 +1864,331 @@ public:
                       Config::WS_HOST, Config::WS_PORT, Config::WS_PATH);
     }
 
-    void loop() { ws_.loop(); }
+    void loop() {
+        if (lock_ == nullptr) return;
+        xSemaphoreTakeRecursive(lock_, portMAX_DELAY);
+        ws_.loop();
+        xSemaphoreGiveRecursive(lock_);
+    }
 
     bool isConnected() { return ws_.isConnected(); }
+#endif
+
+    /** @brief Payload mode in force for the current connection. */
+    uint8_t payloadMode() const { return payloadMode_; }
 
     /**
-     * @brief Transmit a completed batch as a single binary WebSocket frame.
-     * @param batch  Pointer to a fully populated BatchPacket (7744 bytes).
+     * @brief Encode and transmit a completed batch as one binary frame.
+     *
+     * Runs on the sender task only -- the static encode buffer is not
+     * shared with any other caller.
+     *
+     * @param batch  Pointer to a fully populated BatchPacket.
      */
     void sendBatch(const BatchPacket* batch) {
         if (!isConnected()) return;
-        ws_.sendBIN(reinterpret_cast<const uint8_t*>(batch), sizeof(BatchPacket));
+
+        const uint32_t tSend = telemetryCycles();
+
+#if WS_GATHER_SEND
+        // Zero-staging path: describe the message as segments pointing
+        // into the batch pool and let the transport walk them as one
+        // fragmented WebSocket message.  Only derived payloads (RAW_DELTA8
+        // residuals, RAW_PREVIEW8 preview samples) are materialized, into
+        // a scratch 4x smaller than the contiguous buffer this replaces.
+        static WireGather gather;
+        static uint8_t modeScratch[FRAMES_PER_BATCH_MAX * FRAME_SIZE];
+        size_t wireLen = wireGatherBatchV2(batch, payloadMode_,
+                                           takeDroppedDelta(),
+                                           &gather, modeScratch);
+        if (wireLen == 0) return;
+
+        sendGather(gather);
+#else
+        static uint8_t wireBuf[WIRE_BATCH_V2_MAX];
+        size_t wireLen = wireEncodeBatchV2(batch, payloadMode_,
+                                           takeDroppedDelta(),
+                                           wireBuf, sizeof(wireBuf));
+        if (wireLen == 0) return;
+
+        sendBin(wireBuf, wireLen);
+#endif
+        g_telemetry.stages[TSTAGE_WS_SEND].record(telemetryCycles() - tSend);
 
         const BatchHeader& hdr = batch->header;
-        Serial.printf("[TX] Batch #%lu | %d frames | t=%lu ms\n",
-                      hdr.batch_seq, FRAMES_PER_BATCH, hdr.timestamp_ms);
+        Serial.printf("[TX] Batch #%lu | %d frames | mode=%u | %u B | t=%lu ms\n",
+                      hdr.batch_seq, FRAMES_PER_BATCH, payloadMode_,
+                      static_cast<unsigned>(wireLen), hdr.timestamp_ms);
+    }
+
+    /**
+     * @brief Transmit a 24-byte silence marker in place of a suppressed batch.
+     *
+     * Same sender-task-only rule as sendBatch(); the marker carries the
+     * batch's seq/timestamp/frame count so the server's timeline stays
+     * gapless (WIRE_PAYLOAD_SILENCE in protocol_schema.h).
+     */
+    void sendSilenceMarker(const BatchPacket* batch) {
+        if (!isConnected()) return;
+        uint8_t wireBuf[sizeof(BatchHeaderV2)];
+        size_t wireLen = wireEncodeSilenceV2(batch, wireBuf, sizeof(wireBuf));
+        if (wireLen == 0) return;
+        sendBin(wireBuf, wireLen);
+    }
+
+    /**
+     * @brief Export the stage histograms as a binary telemetry message.
+     *
+     * Called from the 10-second stats path in loop() -- off every hot
+     * path.  Percentiles are computed here, once per export, not on
+     * record().
+     */
+    void sendTelemetry() {
+        if (!isConnected()) return;
+        static TelemetryPacket pkt;
+        g_telemetry.exportPacket(&pkt);
+        sendBin(reinterpret_cast<const uint8_t*>(&pkt), sizeof(pkt));
     }
 
-    WebSocketsClient& client() { return ws_; }
+    /**
+     * @brief Acknowledge a downlink control message (CtrlAckPacket).
+     *
+     * Sent from handleControl() for parameters that are validated and
+     * staged immediately; the processor swap's ACK comes from loop()
+     * instead, after the swap actually happened -- the only opcode whose
+     * outcome is not known at validation time.  12 bytes, fits any
+     * transport's queue without staging.
+     */
+    void sendCtrlAck(uint8_t opcode, uint8_t status, uint32_t value) {
+        if (!isConnected()) return;
+        CtrlAckPacket ack = {};
+        ack.magic        = PROTOCOL_MAGIC;
+        ack.version      = PROTOCOL_VERSION_V2;
+        ack.payload_mode = WIRE_PAYLOAD_CTRL_ACK;
+        ack.opcode       = opcode;
+        ack.status       = status;
+        ack.value        = value;
+        sendBin(reinterpret_cast<const uint8_t*>(&ack), sizeof(ack));
+    }
 
 private:
-    WebSocketsClient ws_;
+    /**
+     * @brief Apply a binary downlink control message (transport-neutral).
+     *
+     * Control state changed here is either connection-local (payloadMode_)
+     * or staged through the volatile globals for the processing task --
+     * both safe from whichever task the transport's callback runs on.
+     */
+    void handleControl(const uint8_t* payload, size_t length) {
+        if (length < 2) return;
+        switch (payload[0]) {
+            case WIRE_CTRL_SET_PAYLOAD_MODE:
+                if (payload[1] <= WIRE_PAYLOAD_RAW_DELTA8 ||
+                    payload[1] == WIRE_PAYLOAD_RAW_PREVIEW8) {
+                    payloadMode_ = payload[1];
+                    Serial.printf("[WS] Payload mode -> %u\n", payloadMode_);
+                    sendCtrlAck(payload[0], 1, payloadMode_);
+                } else {
+                    sendCtrlAck(payload[0], 0, payload[1]);
+                }
+                break;
+            case WIRE_CTRL_SET_BATCH_FRAMES:
+                // Applied by the processing task at the next frame
+                // boundary -- never mutate assembly state from here.
+                if (payload[1] >= 1 && payload[1] <= FRAMES_PER_BATCH_MAX) {
+                    g_pendingBatchFrames = payload[1];
+                    sendCtrlAck(payload[0], 1, payload[1]);
+                } else {
+                    sendCtrlAck(payload[0], 0, payload[1]);
+                }
+                break;
+            case WIRE_CTRL_SET_SAMPLE_RATE:
+                if (payload[1] == WIRE_RATE_48K ||
+                    payload[1] == WIRE_RATE_16K) {
+                    g_pendingRateCode = payload[1];
+                    sendCtrlAck(payload[0], 1, payload[1]);
+                } else {
+                    sendCtrlAck(payload[0], 0, payload[1]);
+                }
+                break;
+            case WIRE_CTRL_SET_VAD_GATE:
+                g_vadGateEnabled = (payload[1] != 0);
+                Serial.printf("[WS] VAD gate -> %s\n",
+                              g_vadGateEnabled ? "on" : "off");
+                sendCtrlAck(payload[0], 1, g_vadGateEnabled ? 1 : 0);
+                break;
+            case WIRE_CTRL_SET_GATE_THRESH: {
+                // { op, vad_q8, rms_lo, rms_hi }: both thresholds in one
+                // message so the gate never runs with a mixed pair.
+                if (length < 4) { sendCtrlAck(payload[0], 0, 0); break; }
+                uint16_t rms = static_cast<uint16_t>(payload[2]) |
+                               (static_cast<uint16_t>(payload[3]) << 8);
+                g_gateVadThresh = payload[1] / 255.0f;
+                g_gateRmsFloor  = static_cast<float>(rms);
+                Serial.printf("[WS] Gate thresh -> vad=%.2f rms=%u\n",
+                              payload[1] / 255.0f, rms);
+                sendCtrlAck(payload[0], 1,
+                            payload[1] | (static_cast<uint32_t>(rms) << 8));
+                break;
+            }
+            case WIRE_CTRL_SET_CLEAN_SCALE: {
+                // Clamp to the pipeline's accepted range here so the ACK
+                // carries the value that will actually be applied.
+                uint16_t q8 = payload[1];
+                if (q8 < 64) q8 = 64;                  // 0.25 floor
+                g_pendingCleanScaleQ15 = q8 << 7;      // q8/256 in 1.15
+                Serial.printf("[WS] Clean scale -> %.3f (staged)\n",
+                              q8 / 256.0f);
+                sendCtrlAck(payload[0], 1, q8);
+                break;
+            }
+            case WIRE_CTRL_SET_PROCESSOR:
+                // Swap runs from loop() (the control task owns
+                // swapProcessor()); the ACK follows the actual swap result
+                // from there, not from here -- init can fail.
+                if (payload[1] <= WIRE_PROC_DCBLOCK) {
+                    g_pendingProcessorId = payload[1];
+                } else {
+                    sendCtrlAck(payload[0], 0, payload[1]);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    /** @brief Reset per-connection negotiation so a freshly restarted
+     *         server always gets a format it expects. */
+    void handleDisconnect() {
+        payloadMode_ = WIRE_PAYLOAD_FULL;
+        g_pendingRateCode = WIRE_RATE_48K;
+        g_vadGateEnabled = false;
+        g_gateVadThresh = Config::GATE_VAD_THRESH;
+        g_gateRmsFloor  = Config::GATE_RMS_FLOOR;
+        g_pendingCleanScaleQ15 = CLEAN_PCM_SCALE_Q15;
+        // Deliberately NOT reset: the active processor.  It is device
+        // configuration, not per-connection negotiation -- a server
+        // restart should not silently un-swap the denoiser.
+    }
+
+#if WS_NATIVE_CLIENT
+    /** @brief Transmit one binary frame via the native client's task. */
+    bool sendBin(const uint8_t* data, size_t len) {
+        // The client queues the frame and its own task drains it; the
+        // timeout only matters when that queue is full (link far behind).
+        return esp_websocket_client_send_bin(
+                   client_, reinterpret_cast<const char*>(data), len,
+                   pdMS_TO_TICKS(100)) >= 0;
+    }
+
+#if WS_GATHER_SEND
+    /**
+     * @brief Transmit one batch as a fragmented binary message, straight
+     *        from the gather descriptor's segments.
+     *
+     * First segment opens the message (binary opcode, no FIN), the rest
+     * continue it, send_fin closes it.  The peer reassembles exactly the
+     * bytes the contiguous encoder would have produced.  If a middle
+     * fragment fails the message is unfinishable -- drop the connection
+     * and let the client's auto-reconnect restore a clean stream rather
+     * than desynchronize the peer's parser.
+     */
+    bool sendGather(const WireGather& g) {
+        const TickType_t tmo = pdMS_TO_TICKS(100);
+        if (esp_websocket_client_send_bin_partial(
+                client_, reinterpret_cast<const char*>(g.segs[0].data),
+                g.segs[0].len, tmo) < 0) {
+            return false;   // Nothing on the wire yet -- clean failure
+        }
+        for (int i = 1; i < g.nSegs; i++) {
+            if (esp_websocket_client_send_cont_msg(
+                    client_, reinterpret_cast<const char*>(g.segs[i].data),
+                    g.segs[i].len, tmo) < 0) {
+                Serial.println("[WS] Mid-message send failed -- reconnecting");
+                esp_websocket_client_close(client_, tmo);
+                return false;
+            }
+        }
+        return esp_websocket_client_send_fin(client_, tmo) >= 0;
+    }
+#endif
+
+    static void eventHandler(void* arg, esp_event_base_t /*base*/,
+                             int32_t eventId, void* eventData) {
+        WebSocketManager* self = static_cast<WebSocketManager*>(arg);
+        switch (eventId) {
+            case WEBSOCKET_EVENT_CONNECTED:
+                Serial.println("[WS] Connected");
+                break;
+            case WEBSOCKET_EVENT_DATA: {
+                auto* data = static_cast<esp_websocket_event_data_t*>(eventData);
+                // 0x02 = binary frame; control messages are tiny and never
+                // fragmented, so a partial delivery is ignorable.
+                if (data->op_code == 0x02 && data->payload_offset == 0) {
+                    self->handleControl(
+                        reinterpret_cast<const uint8_t*>(data->data_ptr),
+                        data->data_len);
+                }
+                break;
+            }
+            case WEBSOCKET_EVENT_DISCONNECTED:
+                Serial.println("[WS] Disconnected");
+                self->handleDisconnect();
+                break;
+            default:
+                break;
+        }
+    }
+#else
+    /** @brief Transmit one binary frame under the client mutex.
+     *
+     *  A batch send spans multiple TCP writes; without the lock a
+     *  telemetry or ACK frame from the loop task could land mid-batch and
+     *  interleave bytes of two WebSocket frames, desyncing the peer. */
+    bool sendBin(const uint8_t* data, size_t len) {
+        if (lock_ == nullptr) return false;
+        xSemaphoreTakeRecursive(lock_, portMAX_DELAY);
+        const bool ok = ws_.sendBIN(data, len);
+        xSemaphoreGiveRecursive(lock_);
+        return ok;
+    }
+
+    void onEvent(WStype_t type, uint8_t* payload, size_t length) {
+        switch (type) {
+            case WStype_BIN:
+                handleControl(payload, length);
+                break;
+            case WStype_DISCONNECTED:
+                handleDisconnect();
+                break;
+            default:
+                break;
+        }
+    }
+#endif
+
+    /**
+     * @brief Frames lost on-ESP since the previous transmitted batch.
+     *
+     * Delta of g_telemetry.queueOverruns between consecutive sendBatch()
+     * calls, saturated into the uint16 wire field.  Sender task only, so
+     * the snapshot needs no synchronization.
+     */
+    uint16_t takeDroppedDelta() {
+        const uint32_t now   = g_telemetry.queueOverruns;
+        const uint32_t delta = now - dropSnapshot_;
+        dropSnapshot_ = now;
+        return delta > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(delta);
+    }
+
+#if WS_NATIVE_CLIENT
+    esp_websocket_client_handle_t client_ = nullptr;
+#else
+    WebSocketsClient  ws_;
+    SemaphoreHandle_t lock_ = nullptr;   ///< Serializes ws_ across tasks
+#endif
+    volatile uint8_t payloadMode_ = WIRE_PAYLOAD_FULL;
+    uint32_t         dropSnapshot_ = 0;   ///< queueOverruns at last send
 };
 
 // ============================================================================
@@ -606,45 +2198,328 @@ private:
 static I2SDriver        g_i2s;
 static WebSocketManager g_websocket;
 static AudioPipeline    g_pipeline;
-static QueueHandle_t    g_audioQueue = nullptr;
+static BatchSpillBuffer g_spill;
+
+// Second, small spill ring backing the VAD gate's pre-roll: suppressed
+// batches land here instead of the wire, and evict-oldest naturally keeps
+// just the most recent ones for flushing at speech onset.  Same
+// single-owner rule as g_spill (sender task only).
+static BatchSpillBuffer g_preroll;
+
+// Zero-copy frame transport: capture writes PCM directly into ring slots,
+// processing receives a 1-byte slot index instead of a 968-byte copy.
+static FrameRing<Config::QUEUE_DEPTH> g_frameRing;
+
+// Completed-batch handoff to the sender task: carries BatchPacket pointers
+// only.  Depth BATCH_BUFFERS-1 because one buffer is always assembling.
+static QueueHandle_t g_batchQueue = nullptr;
+
+// Counters + stage histograms (struct defined in telemetry.h)
+Telemetry g_telemetry;
+
+// Task handles, kept only so the stats reporter can query each task's
+// stack high-watermark -- nothing else addresses tasks by handle.
+static TaskHandle_t g_taskCapture    = nullptr;
+static TaskHandle_t g_taskProcessing = nullptr;
+static TaskHandle_t g_taskSender     = nullptr;
+
+// Set by the boot console window ('r'); the replay harness itself runs
+// later in setup(), once the pipeline has its processor attached.
+static bool g_replayRequested = false;
+
+// Tensor-arena pool (struct defined in arena_pool.h): 96 KB of internal
+// RAM reserved at link time, PSRAM overflow for oversized or mid-swap
+// second arenas.
+ArenaPool g_arenaPool;
+
+// ============================================================================
+// MICRO-BENCHMARK SUITE  (setup-time only, see bench.h)
+// ============================================================================
+
+/**
+ * @brief Time every hot-path kernel on both cores and print the results.
+ *
+ * Runs from setup() before WiFi and the audio tasks start, so nothing
+ * preempts the measurement.  Cases cover the kernels the pipeline leans
+ * on per frame: the Q15 headroom scale (and its float fallback), the
+ * energy sum behind rms_raw, the fused I2S 32->16 conversion, the 3:1
+ * decimator, the DC blocker, and the plain memcpy that bounds what any
+ * passthrough-class processor can cost.  Candidate processors can be
+ * timed the same way before promotion: wrap processFrame() in a case.
+ */
+static void runBenchSuite() {
+    // Shared synthetic inputs -- static so the suite costs no task stack.
+    static int16_t pcmIn[FRAME_SIZE];
+    static int16_t pcmOut[FRAME_SIZE];
+    static int32_t pcm32In[FRAME_SIZE];
+    static int16_t dec16[FRAME_SIZE_16K];
+    static Decimator3x      benchDecimator;
+    static DCBlockProcessor benchDcBlock;
+
+    benchFillPcm(pcmIn, FRAME_SIZE, 0xB001);
+    benchFillPcm32(pcm32In, FRAME_SIZE, 0xB002);
+
+    static const BenchCase cases[] = {
+        { "scale_q15 (x0.8)",
+          [](void*) {
+              applyScale(pcmOut, pcmIn, FRAME_SIZE, CLEAN_PCM_SCALE);
+              benchSink(pcmOut[0]);
+          }, nullptr, FRAME_SIZE },
+        { "scale_float (x1.1)",
+          [](void*) {
+              applyScale(pcmOut, pcmIn, FRAME_SIZE, 1.1f);
+              benchSink(pcmOut[0]);
+          }, nullptr, FRAME_SIZE },
+        { "sumsq_s16 (rms)",
+          [](void*) {
+              benchSink(static_cast<uint32_t>(dsp_sumsq_s16(pcmIn, FRAME_SIZE)));
+          }, nullptr, FRAME_SIZE },
+        { "conv32to16+sumsq",
+          [](void*) {
+              benchSink(static_cast<uint32_t>(
+                  dsp_convert32to16_sumsq(pcmOut, pcm32In, FRAME_SIZE)));
+          }, nullptr, FRAME_SIZE },
+        { "decimate 3:1",
+          [](void*) {
+              benchSink(benchDecimator.process(dec16, pcmIn, FRAME_SIZE));
+          }, nullptr, FRAME_SIZE },
+        { "dc_block",
+          [](void*) {
+              benchSink(static_cast<uint32_t>(
+                  benchDcBlock.processFrame(pcmIn, pcmOut, FRAME_SIZE) * 100));
+          }, nullptr, FRAME_SIZE },
+        { "memcpy 480 (passthru)",
+          [](void*) {
+              memcpy(pcmOut, pcmIn, sizeof(pcmIn));
+              benchSink(pcmOut[0]);
+          }, nullptr, FRAME_SIZE },
+    };
+
+    benchRun(cases, sizeof(cases) / sizeof(cases[0]));
+}
+
+// ============================================================================
+// REPLAY HARNESS  (setup-time only, see replay.h)
+// ============================================================================
 
-struct Telemetry {
-    uint32_t framesCaptured  = 0;
-    uint32_t framesProcessed = 0;
-    uint32_t batchesSent     = 0;
-    uint32_t queueOverruns   = 0;
-} g_telemetry;
+/**
+ * @brief Push the replay clip through the live pipeline at maximum speed.
+ *
+ * Calls g_pipeline.processFrame() exactly as taskAudioProcessing does --
+ * same processor, same batch assembly, same headroom scale -- just
+ * without the capture cadence or the cross-core queue hop, neither of
+ * which is part of the per-frame compute being measured.  Must run after
+ * g_pipeline.begin() and BEFORE the RTOS tasks exist: the harness is the
+ * pipeline's only caller here, so the single-consumer rules hold.
+ *
+ * Output: sealed-batch count, the chained output CRC32 (the regression
+ * number -- any kernel change that moves one sample moves it), elapsed
+ * wall time as xN realtime, and the per-stage cycle histograms the 10 s
+ * stats line normally prints.
+ */
+static void runReplaySuite() {
+    const uint32_t frames = replayClipFrames(FRAME_SIZE);
+    Serial.printf("[Replay] %lu frames (%lu s of audio), %s clip\n",
+                  static_cast<unsigned long>(frames),
+                  static_cast<unsigned long>(frames / 100),
+                  REPLAY_HAVE_CLIP ? "embedded" : "synthetic");
+
+    // The histograms should cover only the replay -- reset, run, report.
+    for (int s = 0; s < TSTAGE_COUNT; s++) g_telemetry.stages[s].reset();
+
+    static AudioBuffer slot;   // Stand-in for a ring slot (setup-time only)
+    uint32_t crc     = 0;
+    uint32_t batches = 0;
+    const uint32_t t0us = micros();
+
+    for (uint32_t i = 0; i < frames; i++) {
+        slot.energySumSq = replayFillFrame(slot.pcm, FRAME_SIZE, i);
+        slot.sequence    = i;
+        slot.timestampUs = i * 10000u;   // Nominal capture cadence
+        slot.channel     = 0;
+        if (g_pipeline.processFrame(slot)) {
+            const BatchPacket* batch = g_pipeline.getBatch();
+            crc = replayChecksumBatch(crc, batch, FRAME_SIZE);
+            batches++;
+            g_pipeline.releaseBatch(batch);
+        }
+    }
+
+    const uint32_t wallUs = micros() - t0us;
+    // x100 fixed point so "4.27x realtime" prints without floats
+    const uint32_t x100 = static_cast<uint32_t>(
+        (static_cast<uint64_t>(frames) * 10000u * 100u) / (wallUs ? wallUs : 1));
+    Serial.printf("[Replay] %lu batches  crc32=%08lx  %lu ms  "
+                  "%lu.%02lux realtime\n",
+                  static_cast<unsigned long>(batches),
+                  static_cast<unsigned long>(crc),
+                  static_cast<unsigned long>(wallUs / 1000),
+                  static_cast<unsigned long>(x100 / 100),
+                  static_cast<unsigned long>(x100 % 100));
+
+    static const char* stageNames[TSTAGE_COUNT] =
+        { "i2s_read", "inference", "frame", "ws_send" };
+    for (int s = 0; s < TSTAGE_COUNT; s++) {
+        const CycleHist& h = g_telemetry.stages[s];
+        if (h.samples == 0) continue;
+        Serial.printf("[Replay]  %-9s p50=%6luus  p99=%6luus  max=%6luus  n=%lu\n",
+                      stageNames[s],
+                      h.percentileUs(50),
+                      h.percentileUs(99),
+                      h.maxCycles / TELEMETRY_CYCLES_PER_US,
+                      h.samples);
+    }
+
+    // Leave nothing behind for the live session: the replay's histograms
+    // must not pollute the first real stats interval, and the pipeline's
+    // stream state must not make live frame #0 look like a giant gap.
+    for (int s = 0; s < TSTAGE_COUNT; s++) g_telemetry.stages[s].reset();
+    g_pipeline.resetStreamState();
+}
 
 // ============================================================================
 // RTOS TASK: Audio Capture  (Core 0, high priority)
 // ============================================================================
 
 /**
- * @brief Reads I2S DMA frames and pushes them to g_audioQueue.
+ * @brief Reads I2S DMA frames directly into g_frameRing slots.
  *
  * Intentionally minimal -- no processing here.  Any slowdown in this task
  * causes DMA buffer overrun and introduces audio glitches.
+ *
+ * Event-driven: the task sleeps on the I2S driver's event queue and wakes
+ * exactly when a DMA buffer completes -- no timeout polling, no wakeup
+ * before data exists.  waitFrames() reports how many buffers are already
+ * ready (normally 1; more only when this task got starved), slots are
+ * claimed for exactly that many frames, and one readFrames() call
+ * converts DMA data straight into the slots' pcm buffers.  When the ring
+ * is full a frame is still read (the DMA pipe must keep draining) but
+ * lands in a scratch buffer and is counted as an overrun.  DMA-side
+ * overflows (RX_Q_OVF) are counted separately in telemetry.
  */
 void taskAudioCapture(void* pvParameters) {
-    AudioBuffer buffer;
-    uint32_t    sequence = 0;
+    static int16_t discardPcm[FRAME_SIZE];   // Drain target when ring is full
+    uint32_t       sequence = 0;             // Per frame TIME -- channels
+                                             // captured together share it
+
+    constexpr int MAXN  = Config::CAPTURE_FRAMES_MAX;
+    constexpr int NCH   = Config::CAPTURE_CHANNELS;
+    constexpr int SLOTS = MAXN * NCH;
+    AudioBuffer*  slots[SLOTS];  // Acquired ring slots (nullptr = dropped)
+    int16_t*      dst[SLOTS];    // Destination pointers handed to the driver
+    uint64_t      sumSq[SLOTS];  // Per-frame energy from the conversion pass
+
+    // Low-power idle (Config::POWER_SAVE_ENABLE): frames are drained and
+    // energy-checked but not published.  Wake compares the conversion
+    // pass's sum-of-squares directly against the precomputed threshold --
+    // no sqrt, no extra pass over the samples.
+    bool idle = false;
+    constexpr uint64_t WAKE_SUMSQ = static_cast<uint64_t>(
+        Config::POWER_WAKE_RMS * Config::POWER_WAKE_RMS) * FRAME_SIZE;
 
     Serial.println("[Task] AudioCapture started on Core 0");
 
     while (true) {
-        size_t bytesRead = g_i2s.read(buffer.pcm, 100);
+        // Sleep until DMA signals buffer-ready.  The histogram includes
+        // this wait -- p50 shows the 10 ms DMA cadence, the spread between
+        // p50 and p99 shows scheduler jitter.  The 100 ms limit only
+        // guards against a wedged driver.
+        const uint32_t tRead = telemetryCycles();
+        int avail = g_i2s.waitFrames(MAXN, pdMS_TO_TICKS(100));
+        if (avail == 0) {
+            continue;   // Timeout or overflow-only events -- nothing to read
+        }
 
-        if (bytesRead > 0) {
-            buffer.sequence    = sequence++;
-            buffer.timestampUs = micros();
+        // Claim one slot per channel per frame time DMA actually has.
+        // Slots that cannot be claimed map onto the shared discard buffer --
+        // the read still proceeds so the DMA pipe keeps draining, we just
+        // lose that channel's frame.
+        for (int s = 0; s < avail * NCH; s++) {
+            slots[s] = g_frameRing.acquire();
+            dst[s]   = (slots[s] != nullptr) ? slots[s]->pcm : discardPcm;
+        }
+
+        // The data is already in DMA memory; the short timeout is pure
+        // paranoia, not a pacing mechanism.
+        int framesRead = g_i2s.readFrames(dst, sumSq, avail, 20);
+        g_telemetry.stages[TSTAGE_CAPTURE_READ].record(telemetryCycles() - tRead);
+        uint32_t now   = micros();
+
+        // Idle entry: the sender observed sustained gate silence.  The DMA
+        // drain above keeps running (it must), everything downstream goes
+        // quiet, and the radio drops to modem sleep.
+        if (Config::POWER_SAVE_ENABLE && g_powerIdleRequested && !idle) {
+            idle = true;
+            WiFi.setSleep(true);
+            Serial.println("[Power] idle: capture gated, modem sleep on");
+        }
 
-            if (xQueueSend(g_audioQueue, &buffer, pdMS_TO_TICKS(10)) == pdPASS) {
-                g_telemetry.framesCaptured++;
+        // Idle wake/stay is decided per BURST, never per frame: abort()
+        // only un-reserves the NEWEST reservation, so a burst must either
+        // publish everything it acquired or abort everything it acquired.
+        // Aborting frame f's slots while f+1 still holds later
+        // reservations -- and then publishing those -- would leave
+        // reserved_ pointing at a published slot, handing the next DMA
+        // read a buffer the processing task still owns.
+        if (idle) {
+            // Wake check on energy the conversion pass already produced:
+            // any frame of the burst crossing the threshold on any
+            // channel -- or the server turning the gate off -- wakes.
+            uint64_t peak = 0;
+            for (int s = 0; s < framesRead * NCH; s++) {
+                if (sumSq[s] > peak) peak = sumSq[s];
+            }
+            if (peak >= WAKE_SUMSQ || !g_vadGateEnabled) {
+                idle = false;
+                g_powerIdleRequested = false;
+                WiFi.setSleep(false);
+                Serial.println(g_vadGateEnabled
+                               ? "[Power] wake: energy detected"
+                               : "[Power] wake: gate disabled");
+                // Fall through: the WHOLE burst publishes, quiet lead-in
+                // frames included -- zero samples lost.
             } else {
-                g_telemetry.queueOverruns++;
-                // Frame dropped -- queue full means processing task is behind
+                // Still quiet: nothing in this burst publishes, so every
+                // acquired slot is still among the newest reservations and
+                // can be un-reserved wholesale.  Sequence keeps advancing
+                // (capture time keeps flowing; the gap is deliberate).
+                for (int s = 0; s < avail * NCH; s++) {
+                    if (slots[s] != nullptr) g_frameRing.abort(slots[s]);
+                }
+                g_telemetry.idleFrames += framesRead;
+                sequence += framesRead;
+                continue;
             }
         }
+
+        for (int f = 0; f < avail; f++) {
+            bool gotData = (f < framesRead);
+
+            for (int ch = 0; ch < NCH; ch++) {
+                AudioBuffer* slot = slots[f * NCH + ch];
+
+                if (slot == nullptr) {
+                    if (gotData) g_telemetry.queueOverruns++;
+                    continue;
+                }
+
+                if (gotData) {
+                    slot->sequence    = sequence;
+                    // Back-date earlier frames in the burst: they hit the
+                    // DMA buffer one FRAME_DURATION_US apart but were read
+                    // together.
+                    slot->timestampUs = now - (framesRead - 1 - f) * FRAME_DURATION_US;
+                    slot->energySumSq = sumSq[f * NCH + ch];
+                    slot->channel     = static_cast<uint8_t>(ch);
+                    g_frameRing.publish(slot);
+                    g_telemetry.framesCaptured++;
+                } else {
+                    // Short read: un-reserve the unused slot.
+                    g_frameRing.abort(slot);
+                }
+            }
+            if (gotData) sequence++;
+        }
     }
 }
 
@@ -653,32 +2528,335 @@ void taskAudioCapture(void* pvParameters) {
 // ============================================================================
 
 /**
- * @brief Pulls frames from g_audioQueue, runs inference, and sends batches.
+ * @brief Hand the pipeline's freshly sealed batch to the sender task.
+ *
+ * Drop-oldest under pressure: if the sender's queue is full the oldest
+ * queued batch is evicted so the newest audio keeps flowing.  Called
+ * once per true return from processFrame()/processFiller().
+ */
+static void enqueueSealedBatch() {
+    const BatchPacket* batch = g_pipeline.getBatch();
+
+    if (xQueueSend(g_batchQueue, &batch, 0) != pdPASS) {
+        // Sender is stalled and its queue is full: evict the oldest
+        // queued batch to make room for the newest audio.
+        const BatchPacket* oldest = nullptr;
+        if (xQueueReceive(g_batchQueue, &oldest, 0) == pdTRUE) {
+            g_pipeline.releaseBatch(oldest);
+            g_telemetry.batchesDropped++;
+        }
+        if (xQueueSend(g_batchQueue, &batch, 0) != pdPASS) {
+            // Still no room (cannot happen with a single producer,
+            // but never leak a pool buffer).
+            g_pipeline.releaseBatch(batch);
+            g_telemetry.batchesDropped++;
+        }
+    }
+}
+
+/**
+ * @brief Pulls frames from g_frameRing, runs inference, and sends batches.
  *
  * Inference budget (Design Doc v1.2 sec.5):
- *   ScaledPassThrough  ~0.1 ms/frame
+ *   PassThrough        ~0.1 ms/frame
  *   RNNoise            ~2-5 ms/frame  (240 MHz, -O2)
  *   Hard limit         = 10 ms/frame  (must finish before next frame)
  */
 void taskAudioProcessing(void* pvParameters) {
-    AudioBuffer buffer;
-
     Serial.println("[Task] AudioProcessing started on Core 1");
 
     while (true) {
-        if (xQueueReceive(g_audioQueue, &buffer, portMAX_DELAY) == pdTRUE) {
-            g_telemetry.framesProcessed++;
+        AudioBuffer* buffer = g_frameRing.receive(portMAX_DELAY);
+        if (buffer == nullptr) continue;
+
+        g_telemetry.framesProcessed++;
+
+        // Apply a downlinked batch-depth change at the frame boundary
+        if (g_pendingBatchFrames != 0) {
+            g_pipeline.setFramesPerBatch(g_pendingBatchFrames);
+            g_pendingBatchFrames = 0;
+        }
+
+        // Rate changes are handed to the pipeline here but only take
+        // effect at its next batch boundary (one batch = one rate)
+        if (g_pendingRateCode != 0xFF) {
+            g_pipeline.setSampleRateCode(g_pendingRateCode);
+            g_pendingRateCode = 0xFF;
+        }
+
+        // Headroom-scale changes follow the same staged handoff (pipeline
+        // applies them at its next batch boundary)
+        if (g_pendingCleanScaleQ15 != 0) {
+            g_pipeline.setCleanScale(g_pendingCleanScaleQ15 / 32768.0f);
+            g_pendingCleanScaleQ15 = 0;
+        }
+
+        // Watermark-based backpressure: if the ring is filling (inference
+        // running behind the 10 ms cadence), engage the cheap bypass path
+        // BEFORE frames start dying at the producer.
+        if (g_frameRing.depth() >= Config::RELIEF_DEPTH_THRESH) {
+            g_pipeline.requestRelief();
+        }
+
+        // Close small sequence holes with flagged zero-fillers first
+        // (no-op unless Config::GAP_ZERO_FILL), so the batch assembles in
+        // capture order.  A filler can seal a batch just like a real
+        // frame; collect it before injecting the next.
+        uint32_t fill = g_pipeline.fillerFramesNeeded(*buffer);
+        while (fill-- > 0) {
+            if (g_pipeline.processFiller(buffer->channel)) {
+                enqueueSealedBatch();
+            }
+        }
+
+        // processFrame() calls processor_->processFrame() internally,
+        // which applies CLEAN_PCM_SCALE (0.8) to clean_pcm.
+        bool batchReady = g_pipeline.processFrame(*buffer);
+
+        // Shadow A/B evaluation: spend idle budget (empty ring = nothing
+        // else waiting) running the candidate on the frame just processed.
+        // Must happen before release() -- the shadow reads the slot's PCM.
+        g_pipeline.runShadowFrame(g_frameRing.depth() == 0);
+
+        // The frame is fully consumed by processFrame() (copied into the
+        // batch), so the slot can go back to the capture task immediately --
+        // before any potentially slow WebSocket send.
+        g_frameRing.release(buffer);
+
+        if (batchReady) {
+            enqueueSealedBatch();
+        }
+    }
+}
+
+// ============================================================================
+// RTOS TASK: Batch Sender  (Core 1, low priority)
+// ============================================================================
+
+/**
+ * @brief Transmits completed batches over the WebSocket.
+ *
+ * Runs below the processing task so TCP retransmits and WiFi stalls eat
+ * idle time, never the 10 ms/frame inference budget.  Backpressure policy
+ * is drop-oldest: when this task falls behind, taskAudioProcessing evicts
+ * the stalest queued batch (counted in batchesDropped) so the freshest
+ * audio is always the next thing on the wire.
+ *
+ * OUTAGE HANDLING: while the WebSocket is down, completed batches are
+ * spilled into the PSRAM ring instead of being discarded.  Once the link
+ * returns, up to SPILL_DRAIN_BURST spilled batches are drained after each
+ * live batch -- live audio keeps its latency while the backlog catches up
+ * at roughly 4x realtime.  The server reorders by sequence number.
+ *
+ * VAD GATE (opt-in, WIRE_CTRL_SET_VAD_GATE): an all-silent batch costs a
+ * 24-byte marker instead of kilobytes of room tone -- in a quiet room
+ * that removes most of the uplink.  The suppressed audio is parked in
+ * g_preroll, and when speech starts the pre-roll flushes ahead of the
+ * live batch so the onset keeps its lead-in; a hangover of
+ * GATE_HANGOVER_BATCHES keeps transmitting through short pauses.
+ */
+
+/** @brief True when every frame of the batch looks like silence.
+ *
+ *  Per frame: vad_prob below the VAD threshold OR rms below the floor
+ *  (see the Config comment for why the OR).  Thresholds come from the
+ *  g_gate* globals (Config defaults, tunable via WIRE_CTRL_SET_GATE_THRESH).
+ *  Any active frame makes the whole batch transmit -- the gate never trims
+ *  inside a batch. */
+static bool batchIsSilent(const BatchPacket* batch) {
+    int nFrames = batch->header.reserved[0];
+    if (nFrames < 1 || nFrames > FRAMES_PER_BATCH_MAX) {
+        nFrames = FRAMES_PER_BATCH;
+    }
+    const float vadThresh = g_gateVadThresh;
+    const float rmsFloor  = g_gateRmsFloor;
+    for (int f = 0; f < nFrames; f++) {
+        const AudioFrame& frame = batch->frames[f];
+        bool silent = (frame.vad_prob < vadThresh) ||
+                      (frame.rms_raw  < rmsFloor);
+        if (!silent) return false;
+    }
+    return true;
+}
+
+void taskBatchSender(void* pvParameters) {
+    Serial.println("[Task] BatchSender started on Core 1");
+
+    // Batches left before the gate may suppress again (counts down through
+    // silent batches after the last active one).
+    int hangover = 0;
+
+    // Consecutive suppressed batches -- feeds the low-power idle request
+    // on battery builds (see the power profile section in Config).
+    uint32_t silentRun = 0;
+
+    while (true) {
+        const BatchPacket* batch = nullptr;
+        if (xQueueReceive(g_batchQueue, &batch, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
 
-            // processFrame() calls processor_->processFrame() internally,
-            // which applies CLEAN_PCM_SCALE (0.8) to clean_pcm.
-            bool batchReady = g_pipeline.processFrame(buffer);
+        if (!g_websocket.isConnected()) {
+            // Link down: spill to PSRAM (or fall back to the old silent
+            // drop when no PSRAM is fitted) and free the pool buffer.
+            g_spill.push(batch);
+            g_pipeline.releaseBatch(batch);
+            continue;
+        }
 
-            if (batchReady) {
-                g_websocket.sendBatch(g_pipeline.getBatch());
-                g_pipeline.markTransmitted();
-                g_telemetry.batchesSent++;
+        if (g_vadGateEnabled && g_preroll.enabled()) {
+            if (batchIsSilent(batch)) {
+                if (hangover > 0) {
+                    hangover--;   // Silent, but still inside the hangover
+                } else {
+                    // Gate closed: park the audio for possible pre-roll
+                    // and put only the 24-byte marker on the wire.
+                    g_preroll.push(batch);
+                    g_websocket.sendSilenceMarker(batch);
+                    g_pipeline.releaseBatch(batch);
+                    g_telemetry.batchesSuppressed++;
+                    // Sustained silence: hand the capture task the idle
+                    // request.  No further batches arrive once it takes
+                    // effect, so this fires exactly once per quiet spell.
+                    if (Config::POWER_SAVE_ENABLE &&
+                        ++silentRun >= Config::POWER_IDLE_AFTER_BATCHES) {
+                        g_powerIdleRequested = true;
+                    }
+                    continue;
+                }
+            } else {
+                // Speech: flush the parked lead-in (oldest first) before
+                // the live batch, then re-arm the hangover.
+                const BatchPacket* rolled;
+                while ((rolled = g_preroll.peek()) != nullptr &&
+                       g_websocket.isConnected()) {
+                    g_websocket.sendBatch(rolled);
+                    g_preroll.popDiscard();
+                    g_telemetry.batchesSent++;
+                }
+                hangover = Config::GATE_HANGOVER_BATCHES;
+                silentRun = 0;
             }
+        } else if (g_preroll.pendingBatches() > 0) {
+            // Gate switched off (or connection recycled) with batches still
+            // parked: they will never flush, drop them.
+            while (g_preroll.peek() != nullptr) g_preroll.popDiscard();
+        }
+
+        g_websocket.sendBatch(batch);
+        g_pipeline.releaseBatch(batch);
+        g_telemetry.batchesSent++;
+
+        // Burst-drain the outage backlog, oldest first.  peek() hands back
+        // the record in PSRAM directly; sendBatch() encodes from it without
+        // an internal-RAM staging copy.
+        for (int i = 0; i < Config::SPILL_DRAIN_BURST; i++) {
+            const BatchPacket* spilled = g_spill.peek();
+            if (spilled == nullptr || !g_websocket.isConnected()) break;
+            g_websocket.sendBatch(spilled);
+            g_spill.popDiscard();
+            g_telemetry.batchesSent++;
+        }
+    }
+}
+
+// ============================================================================
+// WIFI FAST-CONNECT  (NVS-cached association, capture runs in parallel)
+// ============================================================================
+
+/**
+ * Cold boots used to serialize everything behind a full WiFi join: scan all
+ * channels, associate, DHCP -- 6-10 s on a busy 2.4 GHz band, all of it
+ * dead air for battery-cycled units that power down between sessions.
+ *
+ * Two fixes, both in setup():
+ *
+ *  1. CACHED ASSOCIATION -- after every successful join the BSSID, channel
+ *     and DHCP lease are persisted to NVS.  The next boot pins the
+ *     association to that exact AP/channel and configures the cached lease
+ *     as a static IP, skipping the scan and the DHCP round trip (~300-700 ms
+ *     total).  If the cache is stale (AP moved channel, lease reassigned)
+ *     the attempt times out after WIFI_FAST_CONNECT_TIMEOUT_MS and falls
+ *     back to a full scan + DHCP, then overwrites the cache.
+ *
+ *  2. PARALLEL BRING-UP -- WiFi.begin() returns immediately, so setup()
+ *     starts I2S and all three audio tasks while association runs.  The
+ *     sender task already spills sealed batches to PSRAM whenever the
+ *     WebSocket is down (g_spill), so audio captured during association is
+ *     queued, not lost: once the socket attaches, the spill drains and the
+ *     session starts from the first sample after boot.
+ *
+ * NVS writes only happen when the cached values actually changed --
+ * steady-state reboots against the same AP wear no flash.
+ */
+
+static Preferences g_wifiPrefs;
+static bool g_wifiFastPath = false;   ///< This boot used the cached target
+
+/** @brief Kick off association (non-blocking) -- cached target if present. */
+static void wifiConnectBegin() {
+    g_wifiPrefs.begin("wifi-fc");
+
+    uint8_t  bssid[6];
+    const bool haveBssid =
+        g_wifiPrefs.getBytes("bssid", bssid, sizeof(bssid)) == sizeof(bssid);
+    const int32_t  channel = g_wifiPrefs.getInt("chan", 0);
+    const uint32_t ip      = g_wifiPrefs.getUInt("ip",   0);
+    const uint32_t gateway = g_wifiPrefs.getUInt("gw",   0);
+    const uint32_t netmask = g_wifiPrefs.getUInt("mask", 0);
+    const uint32_t dns     = g_wifiPrefs.getUInt("dns",  0);
+
+    if (haveBssid && channel > 0 && ip != 0) {
+        WiFi.config(IPAddress(ip), IPAddress(gateway), IPAddress(netmask),
+                    IPAddress(dns));
+        WiFi.begin(Config::WIFI_SSID, Config::WIFI_PASS, channel, bssid);
+        g_wifiFastPath = true;
+        Serial.printf("[WiFi] Fast connect: ch %ld, cached lease %s\n",
+                      (long)channel, IPAddress(ip).toString().c_str());
+    } else {
+        WiFi.begin(Config::WIFI_SSID, Config::WIFI_PASS);
+        Serial.println("[WiFi] No association cache -- full scan");
+    }
+}
+
+/** @brief Block until associated (fast path falls back to a full scan on
+ *         timeout), then refresh the NVS cache from the live connection. */
+static void wifiAwaitConnection() {
+    uint32_t t0 = millis();
+    while (WiFi.status() != WL_CONNECTED) {
+        if (g_wifiFastPath &&
+            millis() - t0 > Config::WIFI_FAST_CONNECT_TIMEOUT_MS) {
+            // Stale cache: AP changed channel or the lease moved.  Restart
+            // with a full scan and DHCP; the cache is rewritten on success.
+            Serial.println("[WiFi] Fast connect timed out -- full scan");
+            WiFi.disconnect(true);
+            WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0),
+                        IPAddress((uint32_t)0));   // All-zero = back to DHCP
+            WiFi.begin(Config::WIFI_SSID, Config::WIFI_PASS);
+            g_wifiFastPath = false;
+            t0 = millis();
         }
+        delay(50);
+    }
+    Serial.printf("[WiFi] Connected in %lu ms -- IP: %s%s\n",
+                  (unsigned long)(millis() - t0),
+                  WiFi.localIP().toString().c_str(),
+                  g_wifiFastPath ? " (fast path)" : "");
+
+    // Refresh the cache -- writes hit flash only on change.
+    uint8_t cached[6] = {0};
+    g_wifiPrefs.getBytes("bssid", cached, sizeof(cached));
+    if (memcmp(cached, WiFi.BSSID(), 6) != 0) {
+        g_wifiPrefs.putBytes("bssid", WiFi.BSSID(), 6);
+    }
+    if (g_wifiPrefs.getInt("chan", 0) != WiFi.channel()) {
+        g_wifiPrefs.putInt("chan", WiFi.channel());
+    }
+    if (g_wifiPrefs.getUInt("ip", 0) != (uint32_t)WiFi.localIP()) {
+        g_wifiPrefs.putUInt("ip",   (uint32_t)WiFi.localIP());
+        g_wifiPrefs.putUInt("gw",   (uint32_t)WiFi.gatewayIP());
+        g_wifiPrefs.putUInt("mask", (uint32_t)WiFi.subnetMask());
+        g_wifiPrefs.putUInt("dns",  (uint32_t)WiFi.dnsIP());
     }
 }
 
@@ -696,25 +2874,54 @@ void setup() {
     Serial.println("  I2S: 32-bit mode (BCLK=64xWS)");
     Serial.println("========================================");
 
-    // WiFi
-    WiFi.begin(Config::WIFI_SSID, Config::WIFI_PASS);
-    Serial.print("[WiFi] Connecting");
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(500);
-        Serial.print(".");
+    // Micro-benchmark suite: before WiFi and the audio tasks, so the radio
+    // and the scheduler cannot perturb the numbers.
+#ifdef BENCH_ON_BOOT
+    runBenchSuite();
+#else
+    Serial.println("[Bench] hold 'b' within 2 s for the benchmark suite, "
+                   "'r' for the replay harness");
+    for (uint32_t t0 = millis(); millis() - t0 < 2000; delay(10)) {
+        if (!Serial.available()) continue;
+        const int key = Serial.read();
+        if (key == 'b') {
+            runBenchSuite();
+            break;
+        }
+        if (key == 'r') {
+            // Replay needs the processor attached -- runs further down,
+            // right after the pipeline comes up.
+            g_replayRequested = true;
+            break;
+        }
     }
-    Serial.printf("\n[WiFi] Connected -- IP: %s\n", WiFi.localIP().toString().c_str());
+#endif
 
-    // WebSocket
-    g_websocket.begin();
+    // WiFi: kick off association only -- it completes in the background
+    // while the audio path comes up below (see WIFI FAST-CONNECT above).
+    wifiConnectBegin();
+
+    // Zero-copy frame ring (statically sized slots, no malloc)
+    if (!g_frameRing.begin()) {
+        Serial.println("[FATAL] Frame ring creation failed -- halting");
+        while (true) delay(100);
+    }
 
-    // Inter-task queue (statically sized, no malloc)
-    g_audioQueue = xQueueCreate(Config::QUEUE_DEPTH, sizeof(AudioBuffer));
-    if (!g_audioQueue) {
-        Serial.println("[FATAL] Queue creation failed -- halting");
+    // Completed-batch pointer queue feeding the sender task
+    g_batchQueue = xQueueCreate(Config::BATCH_BUFFERS - 1, sizeof(BatchPacket*));
+    if (!g_batchQueue) {
+        Serial.println("[FATAL] Batch queue creation failed -- halting");
         while (true) delay(100);
     }
 
+    // PSRAM outage spill ring (optional -- boards without PSRAM just keep
+    // the old drop-on-disconnect behavior)
+    g_spill.begin(Config::SPILL_BYTES);
+
+    // Pre-roll ring for the VAD gate (same optional-PSRAM rule; without it
+    // the gate stays inert and every batch transmits as before)
+    g_preroll.begin(Config::GATE_PREROLL_BYTES);
+
     // I2S hardware
     if (!g_i2s.begin()) {
         Serial.println("[FATAL] I2S init failed -- halting");
@@ -723,36 +2930,82 @@ void setup() {
 
     // ── SELECT INFERENCE STRATEGY ─────────────────────────────────────────
     //
-    //  Option A (current default): Scaled pass-through
-    //    Copies raw audio to clean_pcm at 80% amplitude.
+    //  Option A (current default): Pass-through
+    //    Copies raw audio to clean_pcm (pipeline adds the 0.8 headroom).
     //    Zero latency, guarantees visualizer headroom.
     //
-    static ScaledPassThroughProcessor proc;
-    g_pipeline.begin(&proc, g_audioQueue);
+    static PassThroughProcessor proc;
+    g_pipeline.begin(&proc);
     //
-    //  Option B: AI denoising model (when AIModelProcessor is implemented)
+    //  Option B: RNNoise denoiser (rnnoise_processor.h)
+    //    Needs the ESP-DSP component in lib_deps and a generated
+    //    src/rnnoise_weights.h (tools/export_rnnoise_weights.py); if either
+    //    is missing init() fails and the pipeline falls back to Option A.
     //    Uncomment the two lines below and comment out Option A.
     //
-    //  static AIModelProcessor proc;
-    //  g_pipeline.begin(&proc, g_audioQueue);
+    //  static RNNoiseProcessor proc;
+    //  g_pipeline.begin(&proc);
+    //
+    //  Option C: Processor chain (stages run in array order, one shared
+    //    scratch pair, per-stage timings in the 10 s stats report)
+    //
+    //  static DCBlockProcessor  dcBlock;
+    //  static RNNoiseProcessor  denoiser;
+    //  static IAudioProcessor*  stages[] = { &dcBlock, &denoiser };
+    //  g_pipeline.begin(stages, 2);
+    //
+    //  Shadow-mode A/B evaluation: run a CANDIDATE processor on the same
+    //    input whenever Core 1 has idle budget (frames are skipped when
+    //    the ring backs up), without touching what goes on the wire.  The
+    //    10 s stats report shows its cycle cost against the 10 ms budget
+    //    and its VAD divergence from the primary -- the promotion numbers,
+    //    measured on real fleet audio, with the baseline still deployed.
+    //
+    //  static RNNoiseProcessor shadowCandidate;
+    //  g_pipeline.attachShadow(&shadowCandidate);
     //
     // ──────────────────────────────────────────────────────────────────────
 
-    // RTOS Tasks
+    // Replay harness: the processor just attached is exactly what the
+    // replay exercises, and the tasks do not exist yet, so the harness is
+    // the pipeline's only caller (see runReplaySuite()).
+#ifdef REPLAY_ON_BOOT
+    runReplaySuite();
+#else
+    if (g_replayRequested) runReplaySuite();
+#endif
+
+    // RTOS Tasks (handles kept for the stack high-watermark monitor)
     xTaskCreatePinnedToCore(
         taskAudioCapture,   "AudioCapture",
         Config::TASK_STACK_MIC,  NULL,
-        Config::TASK_PRIO_MIC,   NULL,
+        Config::TASK_PRIO_MIC,   &g_taskCapture,
         Config::CORE_MIC
     );
 
     xTaskCreatePinnedToCore(
         taskAudioProcessing, "AudioProcessing",
         Config::TASK_STACK_PROC, NULL,
-        Config::TASK_PRIO_PROC,  NULL,
+        Config::TASK_PRIO_PROC,  &g_taskProcessing,
         Config::CORE_PROC
     );
 
+    xTaskCreatePinnedToCore(
+        taskBatchSender,     "BatchSender",
+        Config::TASK_STACK_SENDER, NULL,
+        Config::TASK_PRIO_SENDER,  &g_taskSender,
+        Config::CORE_SENDER
+    );
+
+    // Capture is rolling (batches spill to PSRAM while offline); now block
+    // on WiFi and attach the WebSocket.  Nothing recorded so far is lost.
+    wifiAwaitConnection();
+    // Streaming wants the radio awake -- the Arduino core enables modem
+    // sleep by default, which adds tens of ms of uplink jitter.  The
+    // power-idle path turns it back on during silence (battery builds).
+    WiFi.setSleep(false);
+    g_websocket.begin();
+
     Serial.println("[System] Startup complete -- streaming started");
 }
 
@@ -761,17 +3014,131 @@ void setup() {
 // ============================================================================
 
 void loop() {
-    g_websocket.loop();
+    g_websocket.loop();   // No-op under the native event-driven client
+
+    // Downlinked processor swap (WIRE_CTRL_SET_PROCESSOR).  Runs here
+    // because swapProcessor() is control-task-only and may block for up
+    // to a batch; the ACK carries the real outcome -- init() failure or
+    // a swap already in flight reports status 0, audio untouched either
+    // way.  Instances are static like every processor in setup(): a swap
+    // back just revives the same object.
+    if (g_pendingProcessorId != 0xFF) {
+        const uint8_t id = g_pendingProcessorId;
+        g_pendingProcessorId = 0xFF;
+
+        static PassThroughProcessor swapPassthrough;
+        static RNNoiseProcessor     swapRnnoise;
+        static DCBlockProcessor     swapDcBlock;
+        IAudioProcessor* next = nullptr;
+        switch (id) {
+            case WIRE_PROC_PASSTHROUGH: next = &swapPassthrough; break;
+            case WIRE_PROC_RNNOISE:     next = &swapRnnoise;     break;
+            case WIRE_PROC_DCBLOCK:     next = &swapDcBlock;     break;
+        }
+        const bool ok = (next != nullptr) && g_pipeline.swapProcessor(next);
+        Serial.printf("[Control] processor swap -> %u: %s\n",
+                      id, ok ? "ok" : "rejected");
+        g_websocket.sendCtrlAck(WIRE_CTRL_SET_PROCESSOR, ok ? 1 : 0, id);
+    }
 
     static unsigned long lastReport = 0;
     if (millis() - lastReport > 10000UL) {
+        // Watermark sampled (and restarted) per stats interval: a rising
+        // high-water is the early warning that precedes queue overruns.
+        g_telemetry.ringHighWater = g_frameRing.highWater();
+        g_frameRing.clearHighWater();
+
+        // Memory headroom snapshot (internal SRAM only -- the pool a
+        // tensor arena would fight over).  Stack figures are lifetime
+        // low-waters: bytes of each task's stack never touched, i.e. how
+        // far the Config::TASK_STACK_* guesses overshoot.
+        g_telemetry.heapFree    = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+        g_telemetry.heapLargest =
+            heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+        g_telemetry.heapMinFree =
+            heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+        g_telemetry.stackFree[0] = uxTaskGetStackHighWaterMark(g_taskCapture);
+        g_telemetry.stackFree[1] = uxTaskGetStackHighWaterMark(g_taskProcessing);
+        g_telemetry.stackFree[2] = uxTaskGetStackHighWaterMark(g_taskSender);
+
         Serial.printf(
-            "[Stats] captured=%lu  processed=%lu  batches=%lu  overruns=%lu\n",
+            "[Stats] captured=%lu  processed=%lu  batches=%lu  dropped=%lu  "
+            "overruns=%lu  dma_ovf=%lu  ring_hw=%lu/%u\n",
             g_telemetry.framesCaptured,
             g_telemetry.framesProcessed,
             g_telemetry.batchesSent,
-            g_telemetry.queueOverruns
+            g_telemetry.batchesDropped,
+            g_telemetry.queueOverruns,
+            g_telemetry.dmaOverruns,
+            g_telemetry.ringHighWater,
+            g_frameRing.capacity()
         );
+        if (g_pipeline.reliefEngagements() > 0) {
+            Serial.printf("[Stats]   backpressure relief engaged %lu time(s)\n",
+                          g_pipeline.reliefEngagements());
+        }
+        if (g_spill.enabled() &&
+            (g_spill.pendingBatches() > 0 || g_spill.evictions() > 0)) {
+            Serial.printf("[Stats]   spill: pending=%lu  evicted=%lu\n",
+                          g_spill.pendingBatches(), g_spill.evictions());
+        }
+        if (g_telemetry.batchesSuppressed > 0) {
+            Serial.printf("[Stats]   vad gate: suppressed=%lu  preroll=%lu\n",
+                          g_telemetry.batchesSuppressed,
+                          g_preroll.pendingBatches());
+        }
+        if (g_telemetry.idleFrames > 0) {
+            Serial.printf("[Stats]   power idle: %lu frame(s) gated (%lu s)\n",
+                          g_telemetry.idleFrames,
+                          g_telemetry.idleFrames / 100);   // 10 ms frames
+        }
+        if (g_telemetry.gapEvents > 0) {
+            Serial.printf("[Stats]   seq gaps: %lu event(s), %lu frame(s) "
+                          "missing, %lu filled\n",
+                          g_telemetry.gapEvents,
+                          g_telemetry.gapFramesLost,
+                          g_telemetry.fillerFrames);
+        }
+        Serial.printf("[Stats]   mem: heap=%lu B (largest=%lu, min=%lu)  "
+                      "stack free: mic=%lu proc=%lu send=%lu B\n",
+                      g_telemetry.heapFree, g_telemetry.heapLargest,
+                      g_telemetry.heapMinFree,
+                      g_telemetry.stackFree[0], g_telemetry.stackFree[1],
+                      g_telemetry.stackFree[2]);
+        // Alarm re-fires every interval while the condition holds -- a
+        // one-shot line is too easy to scroll past on a serial console.
+        if (g_telemetry.heapFree < Config::MEM_ALARM_HEAP_FREE ||
+            g_telemetry.heapLargest < Config::MEM_ALARM_HEAP_FREE / 2) {
+            Serial.printf("[ALARM] Internal heap low: %lu B free, "
+                          "largest block %lu B\n",
+                          g_telemetry.heapFree, g_telemetry.heapLargest);
+        }
+        static const char* memTaskNames[3] = { "mic", "proc", "send" };
+        for (int t = 0; t < 3; t++) {
+            if (g_telemetry.stackFree[t] < Config::MEM_ALARM_STACK_FREE) {
+                Serial.printf("[ALARM] Task '%s' stack headroom down to "
+                              "%lu B -- raise Config::TASK_STACK_*\n",
+                              memTaskNames[t], g_telemetry.stackFree[t]);
+            }
+        }
+
+        // Per-stage p50/p99 in microseconds (log2 buckets, so factor-of-2
+        // resolution -- enough to spot a deadline miss at a glance)
+        static const char* stageNames[TSTAGE_COUNT] =
+            { "i2s_read", "inference", "frame", "ws_send" };
+        for (int s = 0; s < TSTAGE_COUNT; s++) {
+            const CycleHist& h = g_telemetry.stages[s];
+            if (h.samples == 0) continue;
+            Serial.printf("[Stats]   %-9s p50=%6luus  p99=%6luus  max=%6luus  n=%lu\n",
+                          stageNames[s],
+                          h.percentileUs(50),
+                          h.percentileUs(99),
+                          h.maxCycles / TELEMETRY_CYCLES_PER_US,
+                          h.samples);
+        }
+        g_pipeline.printProcessorStats();
+        g_pipeline.printShadowStats();
+        g_websocket.sendTelemetry();
         lastReport = millis();
     }
 
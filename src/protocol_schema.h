@@ -5,27 +5,234 @@
 
 #define SAMPLE_RATE 48000
 #define FRAME_SIZE 480
-#define FRAMES_PER_BATCH 4
+
+/* Optional decimated capture mode: the mic and frame cadence stay at
+ * 48 kHz / 10 ms, but a 3:1 polyphase stage (decimator.h) shrinks each
+ * frame to 160 samples before inference and the wire.  Negotiated per
+ * session via WIRE_CTRL_SET_SAMPLE_RATE. */
+#define SAMPLE_RATE_16K 16000
+#define FRAME_SIZE_16K  160
+
+/* Default batching depth: 4 frames = 40 ms.  Sessions may negotiate any
+ * depth in [1, FRAMES_PER_BATCH_MAX] at runtime (latency vs. WiFi-overhead
+ * trade-off); buffers are always sized for the max. */
+#define FRAMES_PER_BATCH     4
+#define FRAMES_PER_BATCH_MAX 16
+
+#define PROTOCOL_MAGIC      0xABCD1234u
+#define PROTOCOL_VERSION_V1 0x01
+#define PROTOCOL_VERSION_V2 0x02
+#define PROTOCOL_VERSION    PROTOCOL_VERSION_V2
+
+/* ---------------------------------------------------------------------------
+ * ESP-internal batch assembly format (originally the v1 wire layout; it
+ * diverged when multi-channel capture added the channel id -- the firmware
+ * only emits v2, so the internal struct is free to grow).  The firmware
+ * assembles batches in this layout and encodes the negotiated v2 wire
+ * image from it at send time (see wire_format.h).
+ * ------------------------------------------------------------------------ */
 
 typedef struct __attribute__((packed)) {
     uint32_t frame_seq;
     float    vad_prob;
     float    rms_raw;
-    int16_t  raw_pcm[FRAME_SIZE];
-    int16_t  clean_pcm[FRAME_SIZE];
-} AudioFrame; // Exact 1932 bytes
+    uint8_t  channel;                // Capture channel id (0 = mono / left)
+    uint8_t  flags;                  // WIRE_FRAME_FLAG_* (copied to the wire)
+    uint16_t gap_frames;             // Frames lost immediately before this
+                                     //  one (0 = contiguous; saturates)
+    int16_t  raw_pcm[FRAME_SIZE];    // 16 kHz mode: first FRAME_SIZE_16K valid
+    int16_t  clean_pcm[FRAME_SIZE];  // (wire encoder trims by rate code)
+} AudioFrame; // Exact 1936 bytes
 
 typedef struct __attribute__((packed)) {
     uint32_t magic;         // 0xABCD1234
-    uint8_t  version;       // 0x01
-    uint8_t  reserved[3];
+    uint8_t  version;
+    uint8_t  reserved[3];   // [0]: frames in batch, [1]: rate code (internal)
     uint32_t batch_seq;
     uint32_t timestamp_ms;
 } BatchHeader; // Exact 16 bytes
 
 typedef struct __attribute__((packed)) {
     BatchHeader header;
-    AudioFrame frames[FRAMES_PER_BATCH];
-} BatchPacket; // Exact 7744 bytes
+    AudioFrame frames[FRAMES_PER_BATCH_MAX];  // Only header.reserved[0] used
+} BatchPacket;
+
+/* ---------------------------------------------------------------------------
+ * v2 wire protocol -- negotiated payload modes.
+ *
+ * A v2 message is:  BatchHeaderV2 + N x (FrameHeaderV2 + payload)
+ * where N = frames_per_batch and the payload layout depends on
+ * payload_mode:
+ *
+ *   WIRE_PAYLOAD_FULL         raw int16[480] + clean int16[480]    (1920 B/frame)
+ *   WIRE_PAYLOAD_CLEAN_ONLY   clean int16[480]                     ( 960 B/frame)
+ *   WIRE_PAYLOAD_RAW_DELTA8   clean int16[480] + delta int8[480]   (1440 B/frame)
+ *   WIRE_PAYLOAD_RAW_PREVIEW8 clean int16[480] + preview int16[60] (1080 B/frame)
+ *
+ * RAW_DELTA8: raw and clean are highly correlated (identical up to the 0.8
+ * headroom scale in passthrough mode), so raw is shipped as an int8
+ * residual against the prediction clean * 5/4 (the inverse of
+ * CLEAN_PCM_SCALE = 0.8), right-shifted by WIRE_RAW_DELTA_SHIFT and
+ * clamped.  Reconstruction:
+ *     raw ~= clean * WIRE_RAW_PRED_NUM / WIRE_RAW_PRED_DEN
+ *            + (delta << WIRE_RAW_DELTA_SHIFT)
+ * This is visually lossless for the before/after waveform but NOT
+ * bit-exact; clients needing exact raw PCM must negotiate FULL.
+ *
+ * The mode is selected per connection: the server sends a 2-byte binary
+ * downlink { WIRE_CTRL_SET_PAYLOAD_MODE, mode } after the ESP connects.
+ * Until then (and after every reconnect) the ESP sends FULL.
+ * ------------------------------------------------------------------------ */
+
+#define WIRE_PAYLOAD_FULL       0x00
+#define WIRE_PAYLOAD_CLEAN_ONLY 0x01
+#define WIRE_PAYLOAD_RAW_DELTA8 0x02
+
+/* Silence marker: a BatchHeaderV2 and nothing else (24 bytes instead of
+ * kilobytes).  Sent in place of a suppressed all-silent batch when the
+ * VAD gate is enabled; frames_per_batch still carries the frame count so
+ * the client can account for time.  The suppressed audio itself sits in
+ * the ESP's pre-roll ring and is transmitted in full if speech starts
+ * within GATE_PREROLL_BATCHES batches. */
+#define WIRE_PAYLOAD_SILENCE    0x03
+
+/* Preview mode: clean_pcm ships at full rate, raw_pcm is replaced by an
+ * 8x peak-decimated preview (60 samples per 48 kHz frame).  Each preview
+ * sample is the largest-magnitude sample of its group -- sign preserved --
+ * so the dashboard's before/after envelope looks identical on a few
+ * hundred pixels while the frame shrinks from 1920 to 1080 payload bytes
+ * (~44% less wire).  Debugging capture?  Negotiate FULL and get exact raw
+ * back; the internal batch always holds it. */
+#define WIRE_PAYLOAD_RAW_PREVIEW8 0x04
+#define WIRE_PREVIEW_DECIM        8   /* Raw samples folded per preview sample */
+
+#define WIRE_RAW_PRED_NUM    5   /* inverse of CLEAN_PCM_SCALE = 0.8 ...  */
+#define WIRE_RAW_PRED_DEN    4   /* ... as a ratio: pred = clean * 5 / 4  */
+#define WIRE_RAW_DELTA_SHIFT 2   /* residual resolution: 4 LSB per step   */
+
+/* Uplink telemetry message: shares the v2 magic/version preamble but uses
+ * a dedicated payload_mode so decoders can branch on byte 5. */
+#define WIRE_PAYLOAD_TELEMETRY 0xF0
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // 0xABCD1234
+    uint8_t  version;           // PROTOCOL_VERSION_V2
+    uint8_t  payload_mode;      // WIRE_PAYLOAD_TELEMETRY
+    uint8_t  stage_count;       // Entries in stage[]
+    uint8_t  reserved;
+    uint32_t uptime_ms;
+    uint32_t frames_captured;
+    uint32_t frames_processed;
+    uint32_t batches_sent;
+    uint32_t batches_dropped;
+    uint32_t queue_overruns;
+    uint32_t dma_overruns;      // I2S RX_Q_OVF events
+    uint32_t ring_high_water;   // Max frame-ring depth this interval
+    uint32_t heap_free;         // Free internal SRAM, bytes (MALLOC_CAP_INTERNAL)
+    uint32_t heap_largest;      // Largest contiguous free internal block
+    uint32_t heap_min_free;     // Lifetime low-water of free internal SRAM
+    uint32_t stack_free[3];     // Per-task stack headroom low-water, bytes
+                                //  [0]=capture [1]=processing [2]=sender
+    struct __attribute__((packed)) {
+        uint32_t samples;
+        uint32_t min_cyc;       // All durations in CPU cycles @ 240 MHz
+        uint32_t max_cyc;
+        uint32_t p50_cyc;
+        uint32_t p99_cyc;
+    } stage[4];                 // capture_read, inference, frame_total, ws_send
+} TelemetryPacket;
+
+/* ---------------------------------------------------------------------------
+ * Downlink (server -> ESP) control opcodes.
+ *
+ * Message layout: { opcode, args... } as listed per opcode.  Every control
+ * message is answered with a CtrlAckPacket carrying the value actually
+ * accepted (after clamping/validation) or status 0 on rejection.  An ACK
+ * means "validated and staged" -- parameters that the pipeline defers to a
+ * batch boundary (rate, depth, clean scale) take effect within one batch
+ * of the ACK; the processor swap ACKs only after the swap completed (or
+ * rolled back), since it can genuinely fail at init.
+ * ------------------------------------------------------------------------ */
+#define WIRE_CTRL_SET_PAYLOAD_MODE 0x01
+#define WIRE_CTRL_SET_BATCH_FRAMES 0x02  /* arg: 1..FRAMES_PER_BATCH_MAX */
+#define WIRE_CTRL_SET_SAMPLE_RATE  0x03  /* arg: WIRE_RATE_* */
+#define WIRE_CTRL_SET_VAD_GATE     0x04  /* arg: 0 = off (default), 1 = on */
+#define WIRE_CTRL_SET_GATE_THRESH  0x05  /* args: vad_q8 (u8, /255),
+                                            rms_floor (u16 LE) -- 4-byte msg */
+#define WIRE_CTRL_SET_CLEAN_SCALE  0x06  /* arg: scale_q8 (u8, /256), clamped
+                                            to [0.25, 1.0].  NOTE: RAW_DELTA8's
+                                            predictor stays built for 0.8 --
+                                            other scales fatten its residuals */
+#define WIRE_CTRL_SET_PROCESSOR    0x07  /* arg: WIRE_PROC_* -- hot swap via
+                                            the pipeline's batch-boundary
+                                            machinery, audio never stops */
+
+/* Processor ids for WIRE_CTRL_SET_PROCESSOR */
+#define WIRE_PROC_PASSTHROUGH 0x00
+#define WIRE_PROC_RNNOISE     0x01
+#define WIRE_PROC_DCBLOCK     0x02
+
+/* Uplink control ACK: shares the magic/version preamble, dedicated
+ * payload_mode like telemetry so decoders branch on byte 5. */
+#define WIRE_PAYLOAD_CTRL_ACK 0xF1
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // 0xABCD1234
+    uint8_t  version;           // PROTOCOL_VERSION_V2
+    uint8_t  payload_mode;      // WIRE_PAYLOAD_CTRL_ACK
+    uint8_t  opcode;            // The WIRE_CTRL_* being acknowledged
+    uint8_t  status;            // 1 = applied/staged, 0 = rejected
+    uint32_t value;             // Accepted value, opcode-specific encoding
+                                //  (thresholds pack as vad_q8 | rms << 8)
+} CtrlAckPacket; // Exact 12 bytes
+
+/* sample_rate_code values (negotiated per session; applied at a batch
+ * boundary so every frame of a batch shares one rate) */
+#define WIRE_RATE_48K 0x00
+#define WIRE_RATE_16K 0x01
+
+/* Valid samples per frame for a given sample_rate_code */
+#define WIRE_FRAME_SAMPLES(rate_code) \
+    ((rate_code) == WIRE_RATE_16K ? FRAME_SIZE_16K : FRAME_SIZE)
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // 0xABCD1234
+    uint8_t  version;           // PROTOCOL_VERSION_V2
+    uint8_t  payload_mode;      // WIRE_PAYLOAD_*
+    uint8_t  frames_per_batch;  // Frames in this message
+    uint8_t  sample_rate_code;  // WIRE_RATE_*
+    uint32_t batch_seq;
+    uint32_t timestamp_ms;      // ms since ESP32 boot (no NTP sync)
+    uint32_t payload_crc32;     // CRC32 (zlib polynomial, init 0) over every
+                                //  byte after this header; 0 = not stamped
+                                //  (silence markers have no payload)
+    uint16_t dropped_since_last;// ESP-side frames lost since the previous
+                                //  transmitted batch (queue overruns,
+                                //  saturates at 65535) -- lets the server
+                                //  split ESP drops from network drops
+    uint8_t  reserved_ext[2];   // Must be 0
+} BatchHeaderV2; // Exact 24 bytes
+
+/* Per-frame flag bits (FrameHeaderV2.flags / AudioFrame.flags) */
+#define WIRE_FRAME_FLAG_FILLER 0x01  /* Zero-PCM filler injected to close a
+                                        sequence gap (Config::GAP_ZERO_FILL)
+                                        -- synthetic audio, real timeline */
+
+typedef struct __attribute__((packed)) {
+    uint32_t frame_seq;
+    float    vad_prob;
+    float    rms_raw;
+    uint8_t  channel;           // Capture channel id (0 = mono default)
+    uint8_t  flags;             // WIRE_FRAME_FLAG_* bits
+    uint16_t gap_frames;        // Frames lost immediately before this one
+                                //  (stamped by the pipeline's continuity
+                                //  check; 0 when filled or contiguous)
+} FrameHeaderV2; // Exact 16 bytes
+
+/* Largest possible v2 message (FULL payload, max depth) -- sizes the
+ * encode buffer */
+#define WIRE_BATCH_V2_MAX                                                   \
+    (sizeof(BatchHeaderV2) +                                                \
+     FRAMES_PER_BATCH_MAX * (sizeof(FrameHeaderV2) + 2 * 2 * FRAME_SIZE))
 
 #endif
@@ -0,0 +1,137 @@
+/**
+ * @file replay.h
+ * @brief Deterministic replay harness: known PCM through the real pipeline.
+ *
+ * bench.h times isolated kernels; this harness times (and checksums) the
+ * whole frame path.  A clip embedded in flash is pushed through
+ * AudioPipeline::processFrame() -- same processor, same batch assembly,
+ * same headroom scale -- at maximum speed instead of the 10 ms capture
+ * cadence.  Two numbers come out:
+ *
+ *   - a CRC32 chained across every sealed batch (headers' vad/rms plus
+ *     both PCM streams), so any kernel change that alters a single output
+ *     sample changes the checksum -- a regression gate with no ears and
+ *     no microphone involved;
+ *   - throughput as "xN realtime", from wall time vs the clip's nominal
+ *     duration, plus the usual per-stage cycle histograms.
+ *
+ * CLIP SOURCE: if a generated src/replay_clip.h is present (see
+ * tools/export_replay_clip.py) its recording is used; otherwise a
+ * deterministic synthetic clip of alternating noise bursts and near
+ * silence is generated on the fly -- same sequence every boot and every
+ * firmware version, so checksums stay comparable.  The burst/quiet
+ * pattern exercises the VAD and RMS paths, not just steady-state math.
+ *
+ * Runs from setup() after the processor is attached and BEFORE the RTOS
+ * tasks and WiFi start, like the benchmark suite (runReplaySuite() in
+ * main.cpp).  Setup-time only -- nothing here is on the hot path.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <Arduino.h>
+#include "esp_rom_crc.h"
+#include "protocol_schema.h"
+#include "telemetry.h"
+
+// Generated clip header (optional).  Contract:
+//   REPLAY_CLIP_SAMPLES        total int16 samples (mono, 48 kHz)
+//   const int16_t REPLAY_CLIP_PCM[REPLAY_CLIP_SAMPLES]
+#if defined(__has_include)
+#if __has_include("replay_clip.h")
+#include "replay_clip.h"
+#define REPLAY_HAVE_CLIP 1
+#endif
+#endif
+#ifndef REPLAY_HAVE_CLIP
+#define REPLAY_HAVE_CLIP 0
+#endif
+
+/// Synthetic clip length when no recording is embedded: 10 s of audio
+/// (1000 frames), long enough for stable percentiles and a meaningful
+/// xN figure, short enough to keep boot interactive.
+static constexpr uint32_t REPLAY_SYNTH_FRAMES = 1000;
+
+/// Synthetic burst pattern, in frames: 40 of noise (speech stand-in),
+/// 60 near-silent.  One full cycle per second at the 10 ms cadence.
+static constexpr uint32_t REPLAY_BURST_FRAMES = 40;
+static constexpr uint32_t REPLAY_CYCLE_FRAMES = 100;
+
+/** @brief Number of whole frames the active clip source provides. */
+static inline uint32_t replayClipFrames(int frameSamples) {
+#if REPLAY_HAVE_CLIP
+    return static_cast<uint32_t>(REPLAY_CLIP_SAMPLES / frameSamples);
+#else
+    (void)frameSamples;
+    return REPLAY_SYNTH_FRAMES;
+#endif
+}
+
+/**
+ * @brief Fill one frame of replay PCM and return its energy sum.
+ *
+ * Deterministic in frameIdx alone -- no state between calls, so a replay
+ * is bit-identical regardless of where or how often it runs.  The energy
+ * sum mirrors the fused conversion pass in taskAudioCapture, which
+ * computes sum(pcm^2) while the samples are still in registers.
+ */
+static inline uint64_t replayFillFrame(int16_t* dst, int n,
+                                       uint32_t frameIdx) {
+    uint64_t sumSq = 0;
+#if REPLAY_HAVE_CLIP
+    const int32_t base = static_cast<int32_t>(frameIdx) * n;
+    for (int i = 0; i < n; i++) {
+        const int16_t s = REPLAY_CLIP_PCM[base + i];
+        dst[i] = s;
+        sumSq += static_cast<int64_t>(s) * s;
+    }
+#else
+    // LCG noise (same generator as benchFillPcm), gated by the burst
+    // pattern: full scale during bursts, -36 dB room tone between them.
+    const bool burst = (frameIdx % REPLAY_CYCLE_FRAMES) < REPLAY_BURST_FRAMES;
+    uint32_t s = (frameIdx + 1) * 2654435761u + 1;
+    for (int i = 0; i < n; i++) {
+        s = s * 1664525u + 1013904223u;
+        int16_t v = static_cast<int16_t>(s >> 16);
+        if (!burst) v = static_cast<int16_t>(v / 64);
+        dst[i] = v;
+        sumSq += static_cast<int64_t>(v) * v;
+    }
+#endif
+    return sumSq;
+}
+
+/**
+ * @brief Fold one sealed batch into the running output checksum.
+ *
+ * Covers the per-frame vad/rms results and both PCM streams -- everything
+ * a kernel change could perturb.  Chained esp_rom_crc32_le, so the final
+ * value is order-sensitive across batches as well as within them.
+ */
+static inline uint32_t replayChecksumBatch(uint32_t crc,
+                                           const BatchPacket* batch,
+                                           int frameSamples) {
+    int nFrames = batch->header.reserved[0];
+    if (nFrames < 1 || nFrames > FRAMES_PER_BATCH_MAX) {
+        nFrames = FRAMES_PER_BATCH;
+    }
+    for (int f = 0; f < nFrames; f++) {
+        const AudioFrame& fr = batch->frames[f];
+        crc = esp_rom_crc32_le(crc,
+                  reinterpret_cast<const uint8_t*>(&fr.vad_prob),
+                  sizeof(fr.vad_prob));
+        crc = esp_rom_crc32_le(crc,
+                  reinterpret_cast<const uint8_t*>(&fr.rms_raw),
+                  sizeof(fr.rms_raw));
+        crc = esp_rom_crc32_le(crc,
+                  reinterpret_cast<const uint8_t*>(fr.raw_pcm),
+                  frameSamples * sizeof(int16_t));
+        crc = esp_rom_crc32_le(crc,
+                  reinterpret_cast<const uint8_t*>(fr.clean_pcm),
+                  frameSamples * sizeof(int16_t));
+    }
+    return crc;
+}
+
+#endif // REPLAY_H
@@ -0,0 +1,471 @@
+/**
+ * @file rnnoise_processor.h
+ * @brief RNNoise-style spectral denoiser behind IAudioProcessor.
+ *
+ * The design the whole pipeline was built around: a recurrent network
+ * estimates per-band suppression gains on 10 ms frames, and the gains are
+ * applied in the frequency domain with windowed overlap-add.  Structure
+ * follows RNNoise (Valin 2018) adapted to this firmware:
+ *
+ *   1. ANALYSIS   960-sample Vorbis window (current + previous frame),
+ *                 zero-padded 1024-point FFT via the ESP-DSP radix-4
+ *                 float routines (PIE-vectorized on the S3), folded into
+ *                 22 Bark-spaced band energies.
+ *   2. NETWORK    Quantized GRU stack -- int8 weights in flash (.rodata,
+ *                 no SPIFFS read anywhere near the hot path), Q15
+ *                 activations, int32 MACs, sigmoid/tanh via interpolated
+ *                 LUTs.  Outputs 22 band gains and a VAD probability.
+ *   3. SYNTHESIS  Per-bin gain interpolation, inverse FFT, window,
+ *                 overlap-add.  One frame of algorithmic lookback, same
+ *                 10 ms cadence out as in.
+ *
+ * WEIGHTS: the network topology and weight arrays live in a GENERATED
+ * header (rnnoise_weights.h, produced by tools/export_rnnoise_weights.py
+ * from a trained model).  Builds without it -- or without the ESP-DSP
+ * component -- still compile: init() reports the missing piece and
+ * returns false, which rides the pipeline's existing automatic fallback
+ * to PassThroughProcessor.  Audio always flows.
+ *
+ * BUDGET: two 1024-point FFTs plus ~25k int8 MACs lands in the 2-5 ms
+ * envelope from the Design Doc; per-stage cycle histograms (analysis /
+ * network / synthesis) report through printStats() on the 10 s stats
+ * path so the budget claim is checked on real silicon, not assumed.
+ *
+ * PITCH: RNNoise's pitch-comb filtering stage is deliberately omitted in
+ * this first landing -- it buys intelligibility in heavy noise at the
+ * cost of a correlation search per frame, and the band-gain path must
+ * prove its budget on target first.
+ */
+
+#ifndef RNNOISE_PROCESSOR_H
+#define RNNOISE_PROCESSOR_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "protocol_schema.h"
+#include "telemetry.h"
+#include "arena_pool.h"
+
+#if __has_include("dsps_fft4r.h")
+#include "dsps_fft4r.h"
+#define RNNOISE_HAVE_ESP_DSP 1
+#else
+#define RNNOISE_HAVE_ESP_DSP 0
+#endif
+
+#if __has_include("rnnoise_weights.h")
+#include "rnnoise_weights.h"
+#define RNNOISE_HAVE_WEIGHTS 1
+#else
+#define RNNOISE_HAVE_WEIGHTS 0
+#endif
+
+#if RNNOISE_HAVE_ESP_DSP && RNNOISE_HAVE_WEIGHTS
+
+// ---------------------------------------------------------------------------
+// Fixed-point activation kernels (Q15 in, Q15 out)
+// ---------------------------------------------------------------------------
+
+namespace rnn_detail {
+
+/// 65-entry sigmoid table over [-8, 8] in 0.25 steps, Q15 outputs, linear
+/// interpolation between entries.  Max interpolation error is below 1e-3
+/// -- indistinguishable through an int8-quantized network.
+static const int16_t SIGMOID_LUT[65] = {
+       11,    14,    18,    23,    30,    38,    49,    63,
+       81,   104,   133,   171,   219,   281,   360,   461,
+      589,   753,   961,  1223,  1554,  1969,  2486,  3124,
+     3906,  4851,  5978,  7297,  8813, 10513, 12371, 14347,
+    16384, 18421, 20397, 22255, 23955, 25471, 26790, 27917,
+    28862, 29644, 30282, 30799, 31214, 31545, 31807, 32015,
+    32179, 32307, 32408, 32487, 32549, 32597, 32635, 32664,
+    32687, 32705, 32719, 32730, 32738, 32745, 32750, 32754,
+    32757
+};
+
+/** @brief sigmoid(x) for a Q12 pre-activation, Q15 result in [0, 32767]. */
+static inline int16_t sigmoidQ(int32_t preactQ12) {
+    // Clamp to the LUT domain [-8, 8) in Q12.
+    if (preactQ12 >  8 * 4096 - 1) preactQ12 =  8 * 4096 - 1;
+    if (preactQ12 < -8 * 4096)     preactQ12 = -8 * 4096;
+    // 64 segments over 16.0 -> each segment is 1024 Q12 steps.
+    const int32_t biased = preactQ12 + 8 * 4096;
+    const int32_t idx    = biased >> 10;
+    const int32_t frac   = biased & 1023;          // Q10 position in segment
+    const int32_t a = SIGMOID_LUT[idx];
+    const int32_t b = SIGMOID_LUT[idx + 1];
+    int32_t v = a + (((b - a) * frac) >> 10);
+    if (v > 32767) v = 32767;
+    return static_cast<int16_t>(v);
+}
+
+/** @brief tanh(x) via the identity tanh(x) = 2*sigmoid(2x) - 1, Q15. */
+static inline int16_t tanhQ(int32_t preactQ12) {
+    // 2x in Q12; sigmoidQ clamps internally.
+    const int32_t s = sigmoidQ(preactQ12 * 2);     // Q15 in [0, 1]
+    int32_t v = 2 * s - 32768;
+    if (v >  32767) v =  32767;
+    if (v < -32768) v = -32768;
+    return static_cast<int16_t>(v);
+}
+
+/**
+ * @brief Dense pre-activation: (W x + b) in Q12.
+ *
+ * Weights are int8 with scale 1/64 (exported clamped to [-2, 2)),
+ * activations Q15; the product >> (15 + 6 - 12) lands in Q12.  int32
+ * accumulation is exact for any layer this network's size.
+ */
+static inline int32_t dotQ(const int8_t* w, const int16_t* x, int n,
+                           int32_t biasQ12) {
+    int32_t acc = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc += w[i + 0] * x[i + 0] + w[i + 1] * x[i + 1] +
+               w[i + 2] * x[i + 2] + w[i + 3] * x[i + 3];
+    }
+    for (; i < n; ++i) acc += w[i] * x[i];
+    return (acc >> 9) + biasQ12;    // (Q15 * 2^-6 weights) >> 9 -> Q12
+}
+
+} // namespace rnn_detail
+
+#endif // RNNOISE_HAVE_ESP_DSP && RNNOISE_HAVE_WEIGHTS
+
+/**
+ * @class RNNoiseProcessor
+ * @brief Production fixed-point denoiser (see file header for structure).
+ *
+ * Operates at the native 48 kHz rate only: in decimated 16 kHz sessions
+ * processFrame() degrades to passthrough (the band layout and window are
+ * rate-specific; a 16 kHz variant needs retrained weights, not a resample
+ * hack).  All per-frame state is member data; the large transient FFT
+ * scratch and the window table come from g_arenaPool per the
+ * AIModelProcessor implementation guide.
+ */
+class RNNoiseProcessor : public IAudioProcessor {
+#if RNNOISE_HAVE_ESP_DSP && RNNOISE_HAVE_WEIGHTS
+public:
+    bool init() override {
+        static_assert(RNN_NB_BANDS == NB_BANDS,
+                      "Weights were exported for a different band layout");
+        static_assert(RNN_NB_FEATURES == 2 * NB_BANDS,
+                      "Feature layout is 22 log energies + 22 deltas");
+
+        if (dsps_fft4r_init_fc32(nullptr, FFT_SIZE) != ESP_OK) {
+            Serial.println("[RNNoise] FFT table init failed");
+            return false;
+        }
+
+        // Transient scratch: complex FFT buffer + analysis window table.
+        arena_ = g_arenaPool.acquire(ARENA_BYTES);
+        if (arena_ == nullptr) {
+            Serial.println("[RNNoise] Arena acquire failed");
+            return false;
+        }
+        fftBuf_ = static_cast<float*>(arena_);
+        window_ = fftBuf_ + 2 * FFT_SIZE;
+
+        // Vorbis power-complementary window, same shape RNNoise trains
+        // with -- analysis and synthesis share it, so the overlap-add
+        // reconstructs exactly at unity gain.
+        for (int i = 0; i < WIN_SIZE; i++) {
+            const float t = sinf((float)M_PI * (i + 0.5f) / WIN_SIZE);
+            window_[i] = sinf(0.5f * (float)M_PI * t * t);
+        }
+
+        reset();
+        Serial.printf("[RNNoise] Ready: %d bands, GRU %d, weights v%d\n",
+                      NB_BANDS, RNN_GRU_UNITS, RNN_WEIGHTS_VERSION);
+        return true;
+    }
+
+    void deinit() override {
+        g_arenaPool.release(arena_);
+        arena_  = nullptr;
+        fftBuf_ = nullptr;
+        window_ = nullptr;
+    }
+
+    float processFrame(const int16_t* input, int16_t* output,
+                       int nSamples) override {
+        if (nSamples != FRAME_SIZE) {
+            // Decimated session -- this model is 48 kHz-only (see class
+            // doc).  Pass through rather than feed the net garbage.
+            memcpy(output, input, nSamples * sizeof(int16_t));
+            return 1.0f;
+        }
+
+        // ---- 1. Analysis: window, FFT, band energies -------------------
+        uint32_t t0 = telemetryCycles();
+
+        float* re = fftBuf_;                 // Interleaved complex [re, im]
+        for (int i = 0; i < FRAME_SIZE; i++) {
+            re[2 * i]                       = window_[i] * prevFrame_[i];
+            re[2 * i + 1]                   = 0.0f;
+            re[2 * (FRAME_SIZE + i)]        = window_[FRAME_SIZE + i] * input[i];
+            re[2 * (FRAME_SIZE + i) + 1]    = 0.0f;
+        }
+        for (int i = WIN_SIZE; i < FFT_SIZE; i++) {   // Zero-pad to 1024
+            re[2 * i]     = 0.0f;
+            re[2 * i + 1] = 0.0f;
+        }
+        memcpy(prevFrame_, input, sizeof(prevFrame_));
+
+        dsps_fft4r_fc32(re, FFT_SIZE);
+        dsps_bit_rev4r_fc32(re, FFT_SIZE);
+
+        float bandE[NB_BANDS];
+        computeBandEnergies(re, bandE);
+        analysisHist_.record(telemetryCycles() - t0);
+
+        // ---- 2. Network: features -> band gains + VAD ------------------
+        t0 = telemetryCycles();
+        float vad = runNetwork(bandE);
+        rnnHist_.record(telemetryCycles() - t0);
+
+        // ---- 3. Synthesis: apply gains, IFFT, overlap-add --------------
+        t0 = telemetryCycles();
+        applyBandGains(re);
+        inverseFFT(re);
+
+        for (int i = 0; i < FRAME_SIZE; i++) {
+            // First half of the windowed result + the tail saved from the
+            // previous frame completes the power-complementary pair.
+            float s = re[2 * i] * window_[i] + synthTail_[i];
+            if (s >  32767.0f) s =  32767.0f;
+            if (s < -32768.0f) s = -32768.0f;
+            output[i] = static_cast<int16_t>(s);
+            synthTail_[i] = re[2 * (FRAME_SIZE + i)] * window_[FRAME_SIZE + i];
+        }
+        synthesisHist_.record(telemetryCycles() - t0);
+
+        return vad;
+    }
+
+    const char* getName() const override { return "RNNoise"; }
+
+    /** @brief Per-stage p50/p99/max, same format as the chain's stats. */
+    void printStats() const override {
+        static const char* names[3] = { "rnn:analysis", "rnn:network",
+                                        "rnn:synthesis" };
+        const CycleHist* hists[3] = { &analysisHist_, &rnnHist_,
+                                      &synthesisHist_ };
+        for (int s = 0; s < 3; s++) {
+            if (hists[s]->samples == 0) continue;
+            Serial.printf("[Stats]   %-14s p50=%6luus  p99=%6luus  max=%6luus\n",
+                          names[s],
+                          hists[s]->percentileUs(50),
+                          hists[s]->percentileUs(99),
+                          hists[s]->maxCycles / TELEMETRY_CYCLES_PER_US);
+        }
+    }
+
+private:
+    static constexpr int FFT_SIZE = 1024;   ///< Radix-4 friendly, > WIN_SIZE
+    static constexpr int WIN_SIZE = 2 * FRAME_SIZE;   ///< 960, 50 % overlap
+    static constexpr int NB_BANDS = 22;
+    static constexpr int FREQ_BINS = FFT_SIZE / 2 + 1;
+
+    /// Arena: complex FFT buffer (2*1024 floats) + window table (960).
+    static constexpr size_t ARENA_BYTES =
+        (2 * FFT_SIZE + WIN_SIZE) * sizeof(float);
+
+    /// Bark-spaced band edges in FFT bins (46.875 Hz/bin at 48 kHz/1024).
+    /// 23 edges bound 22 bands from DC to ~23.4 kHz.
+    static constexpr int16_t BAND_EDGES[NB_BANDS + 1] = {
+        0,   2,   4,   6,   8,  10,  12,  14,  16,  20,  24,  28,
+        34,  40,  48,  60,  78, 100, 128, 170, 230, 320, 500
+    };
+
+    void reset() {
+        memset(prevFrame_, 0, sizeof(prevFrame_));
+        memset(synthTail_, 0, sizeof(synthTail_));
+        memset(gruState_,  0, sizeof(gruState_));
+        memset(prevFeat_,  0, sizeof(prevFeat_));
+        memset(gains_,     0, sizeof(gains_));
+    }
+
+    /** @brief Fold |X|^2 into the 22 Bark bands. */
+    void computeBandEnergies(const float* spec, float* bandE) {
+        for (int b = 0; b < NB_BANDS; b++) {
+            float e = 1e-2f;   // Floor keeps the log finite in silence
+            for (int k = BAND_EDGES[b]; k < BAND_EDGES[b + 1]; k++) {
+                const float rr = spec[2 * k];
+                const float ii = spec[2 * k + 1];
+                e += rr * rr + ii * ii;
+            }
+            bandE[b] = e;
+        }
+    }
+
+    /**
+     * @brief Quantized GRU stack: log-band features in, gains + VAD out.
+     *
+     * Features (Q15, roughly [-1, 1]): 22 scaled log band energies plus
+     * their first differences against the previous frame -- the deltas
+     * are what lets a small GRU separate onset transients from steady
+     * noise.  All layer math is int8 x Q15 with int32 accumulation; see
+     * rnn_detail for the scale conventions.
+     */
+    float runNetwork(const float* bandE) {
+        using namespace rnn_detail;
+
+        // Feature extraction: log2 energy scaled so ~96 dB of dynamic
+        // range maps into the Q15 domain.
+        int16_t feat[RNN_NB_FEATURES];
+        for (int b = 0; b < NB_BANDS; b++) {
+            float f = 0.08f * (log2f(bandE[b]) - 10.0f);
+            if (f >  0.999f) f =  0.999f;
+            if (f < -0.999f) f = -0.999f;
+            const int16_t q = static_cast<int16_t>(f * 32767.0f);
+            int32_t d = q - prevFeat_[b];         // Saturate: worst-case
+            if (d >  32767) d =  32767;           //  swing is 2x the Q15
+            if (d < -32768) d = -32768;           //  range
+            feat[b]            = q;
+            feat[NB_BANDS + b] = static_cast<int16_t>(d);
+            prevFeat_[b]       = q;
+        }
+
+        // Input dense layer (tanh).
+        int16_t dense[RNN_DENSE_UNITS];
+        for (int j = 0; j < RNN_DENSE_UNITS; j++) {
+            dense[j] = tanhQ(dotQ(&rnn_input_w[j * RNN_NB_FEATURES], feat,
+                                  RNN_NB_FEATURES, rnn_input_b[j]));
+        }
+
+        // GRU layer: z/r gates then candidate state.
+        int16_t z[RNN_GRU_UNITS], r[RNN_GRU_UNITS];
+        for (int j = 0; j < RNN_GRU_UNITS; j++) {
+            z[j] = sigmoidQ(dotQ(&rnn_gru_wz[j * RNN_DENSE_UNITS], dense,
+                                 RNN_DENSE_UNITS, rnn_gru_bz[j]) +
+                            dotQ(&rnn_gru_uz[j * RNN_GRU_UNITS], gruState_,
+                                 RNN_GRU_UNITS, 0));
+            r[j] = sigmoidQ(dotQ(&rnn_gru_wr[j * RNN_DENSE_UNITS], dense,
+                                 RNN_DENSE_UNITS, rnn_gru_br[j]) +
+                            dotQ(&rnn_gru_ur[j * RNN_GRU_UNITS], gruState_,
+                                 RNN_GRU_UNITS, 0));
+        }
+        int16_t gated[RNN_GRU_UNITS];
+        for (int j = 0; j < RNN_GRU_UNITS; j++) {
+            gated[j] = static_cast<int16_t>((r[j] * gruState_[j]) >> 15);
+        }
+        for (int j = 0; j < RNN_GRU_UNITS; j++) {
+            const int16_t h = tanhQ(
+                dotQ(&rnn_gru_wh[j * RNN_DENSE_UNITS], dense,
+                     RNN_DENSE_UNITS, rnn_gru_bh[j]) +
+                dotQ(&rnn_gru_uh[j * RNN_GRU_UNITS], gated,
+                     RNN_GRU_UNITS, 0));
+            // h' = z*h_prev + (1-z)*h_cand, all Q15.
+            gruState_[j] = static_cast<int16_t>(
+                (z[j] * gruState_[j] + (32768 - z[j]) * h) >> 15);
+        }
+
+        // Output heads: 22 sigmoid band gains, 1 sigmoid VAD.
+        for (int b = 0; b < NB_BANDS; b++) {
+            const int16_t g = sigmoidQ(dotQ(&rnn_gains_w[b * RNN_GRU_UNITS],
+                                            gruState_, RNN_GRU_UNITS,
+                                            rnn_gains_b[b]));
+            gains_[b] = g * (1.0f / 32768.0f);
+        }
+        const int16_t v = sigmoidQ(dotQ(rnn_vad_w, gruState_,
+                                        RNN_GRU_UNITS, rnn_vad_b[0]));
+        return v * (1.0f / 32768.0f);
+    }
+
+    /** @brief Multiply the spectrum by per-bin gains, linearly
+     *         interpolated between band centers (hard band steps ring). */
+    void applyBandGains(float* spec) {
+        for (int b = 0; b < NB_BANDS; b++) {
+            const float g0 = gains_[b];
+            const float g1 = (b + 1 < NB_BANDS) ? gains_[b + 1] : gains_[b];
+            const int   k0 = BAND_EDGES[b];
+            const int   k1 = BAND_EDGES[b + 1];
+            const float step = (k1 > k0) ? 1.0f / (k1 - k0) : 0.0f;
+            for (int k = k0; k < k1; k++) {
+                const float g = g0 + (g1 - g0) * (k - k0) * step;
+                spec[2 * k]     *= g;
+                spec[2 * k + 1] *= g;
+            }
+        }
+        // Bins above the last band edge carry no speech -- mute them, and
+        // mirror the gained half onto the conjugate half so the inverse
+        // transform comes back real.
+        for (int k = BAND_EDGES[NB_BANDS]; k < FREQ_BINS; k++) {
+            spec[2 * k]     = 0.0f;
+            spec[2 * k + 1] = 0.0f;
+        }
+        for (int k = 1; k < FFT_SIZE / 2; k++) {
+            spec[2 * (FFT_SIZE - k)]     =  spec[2 * k];
+            spec[2 * (FFT_SIZE - k) + 1] = -spec[2 * k + 1];
+        }
+    }
+
+    /** @brief In-place inverse FFT via conjugation around the forward
+     *         radix-4 routine, including the 1/N normalization. */
+    void inverseFFT(float* spec) {
+        for (int k = 0; k < FFT_SIZE; k++) spec[2 * k + 1] = -spec[2 * k + 1];
+        dsps_fft4r_fc32(spec, FFT_SIZE);
+        dsps_bit_rev4r_fc32(spec, FFT_SIZE);
+        const float inv = 1.0f / FFT_SIZE;
+        for (int k = 0; k < FFT_SIZE; k++) {
+            spec[2 * k]     *=  inv;
+            spec[2 * k + 1] *= -inv;
+        }
+    }
+
+    // Arena-backed scratch (transient per frame, see ARENA_BYTES)
+    void*  arena_  = nullptr;
+    float* fftBuf_ = nullptr;   ///< 2 * FFT_SIZE interleaved complex floats
+    float* window_ = nullptr;   ///< WIN_SIZE Vorbis window table
+
+    // Persistent per-stream state (small, static like everything else)
+    int16_t prevFrame_[FRAME_SIZE];       ///< Analysis lookback (10 ms)
+    float   synthTail_[FRAME_SIZE];       ///< Overlap-add carry
+    int16_t gruState_[RNN_GRU_UNITS];     ///< Recurrent state, Q15
+    int16_t prevFeat_[NB_BANDS];          ///< For the delta features, Q15
+    float   gains_[NB_BANDS];             ///< Last band gains [0, 1]
+
+    // Per-stage timing, reported via printStats()
+    CycleHist analysisHist_;
+    CycleHist rnnHist_;
+    CycleHist synthesisHist_;
+
+#else // !(RNNOISE_HAVE_ESP_DSP && RNNOISE_HAVE_WEIGHTS)
+public:
+    /**
+     * @brief Build is missing ESP-DSP and/or the generated weights header.
+     *
+     * Returning false rides the pipeline's automatic fallback to
+     * PassThroughProcessor -- audio keeps flowing, just undenoised.
+     */
+    bool init() override {
+#if !RNNOISE_HAVE_ESP_DSP
+        Serial.println("[RNNoise] ESP-DSP component not in build -- "
+                       "add esp-dsp to lib_deps");
+#endif
+#if !RNNOISE_HAVE_WEIGHTS
+        Serial.println("[RNNoise] rnnoise_weights.h not generated -- "
+                       "run tools/export_rnnoise_weights.py");
+#endif
+        return false;
+    }
+
+    float processFrame(const int16_t* input, int16_t* output,
+                       int nSamples) override {
+        memcpy(output, input, nSamples * sizeof(int16_t));   // Unreachable
+        return 1.0f;
+    }
+
+    const char* getName() const override { return "RNNoise(unavailable)"; }
+#endif // RNNOISE_HAVE_ESP_DSP && RNNOISE_HAVE_WEIGHTS
+};
+
+#if RNNOISE_HAVE_ESP_DSP && RNNOISE_HAVE_WEIGHTS
+// Out-of-class definition: the band loops index the table at runtime,
+// which odr-uses it, and under gnu++11 a constexpr member has no implicit
+// definition (same fix as Decimator3x::COEFFS_Q15 in decimator.h).
+constexpr int16_t RNNoiseProcessor::BAND_EDGES[];
+#endif
+
+#endif // RNNOISE_PROCESSOR_H
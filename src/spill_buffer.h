@@ -0,0 +1,172 @@
+/**
+ * @file spill_buffer.h
+ * @brief PSRAM ring buffer that absorbs completed batches during WiFi outages.
+ *
+ * When the link drops, sendBatch() used to silently discard every batch for
+ * the whole reconnect interval (5 s and often more).  The S3 dev kit has
+ * 8 MB of PSRAM doing nothing, so the sender task now spills sealed batches
+ * here while disconnected and bursts them back out at higher-than-realtime
+ * rate once the link returns.  Sequence numbers already in BatchHeader let
+ * the server put live and recovered batches back in order.
+ *
+ * CAPACITY: a default-depth batch stores 16 + 4*1932 = 7744 bytes, so the
+ * 6 MB default ring holds ~810 batches = ~32 s of full-payload audio --
+ * enough to ride out several reconnect cycles back to back.  When the ring
+ * itself fills, the oldest batches are evicted first (newest audio wins,
+ * same policy as the sender queue).
+ *
+ * STORAGE FORMAT: [u32 length][BatchHeader + N used AudioFrames] ...
+ * Records never wrap: if the tail gap is too small a skip marker is
+ * written and the record starts at offset 0.  Because a record is a
+ * byte-exact prefix of BatchPacket, peek() can hand the drain path a
+ * directly usable `const BatchPacket*` inside PSRAM -- no staging copy in
+ * internal RAM.
+ *
+ * CONCURRENCY: push, peek and popDiscard are all called from the sender
+ * task only.  Single-owner by design, no locks.
+ */
+
+#ifndef SPILL_BUFFER_H
+#define SPILL_BUFFER_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include "protocol_schema.h"
+
+class BatchSpillBuffer {
+public:
+    /**
+     * @brief Allocate the PSRAM ring.  Call once from setup().
+     * @param bytes  Ring capacity; trimmed automatically if PSRAM is smaller.
+     * @return true if PSRAM was found and allocated; false disables spilling
+     *         (the sender falls back to the old drop-on-disconnect behavior).
+     */
+    bool begin(size_t bytes) {
+        if (!psramFound()) {
+            Serial.println("[Spill] No PSRAM -- outage spilling disabled");
+            return false;
+        }
+        size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+        if (bytes > largest) bytes = largest - (largest / 8);  // Leave headroom
+        buf_ = static_cast<uint8_t*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM));
+        if (buf_ == nullptr) {
+            Serial.println("[Spill] PSRAM allocation failed -- spilling disabled");
+            return false;
+        }
+        cap_ = bytes;
+        Serial.printf("[Spill] %u KB PSRAM ring ready (~%u batches)\n",
+                      static_cast<unsigned>(cap_ / 1024),
+                      static_cast<unsigned>(cap_ / (sizeof(uint32_t) + 7744)));
+        return true;
+    }
+
+    bool enabled() const { return buf_ != nullptr; }
+
+    /**
+     * @brief Copy one sealed batch into the ring, evicting oldest on overflow.
+     * @param batch  Sealed batch; frame count read from header.reserved[0].
+     * @return true if stored (false only when spilling is disabled).
+     */
+    bool push(const BatchPacket* batch) {
+        if (!enabled()) return false;
+
+        const size_t len    = recordLen(batch->header.reserved[0]);
+        const size_t needed = sizeof(uint32_t) + len;
+
+        // A wrap gap only arises when free space spans the buffer end; it
+        // must be budgeted for before eviction so the record never lands on
+        // unread data.
+        const size_t gap = (head_ + needed > cap_) ? (cap_ - head_) : 0;
+
+        // Evict oldest records until the new one (plus any gap) fits.
+        while (freeBytes() < gap + needed) {
+            if (!popDiscard()) return false;   // Should not happen
+            evictions_++;
+        }
+
+        // Keep records contiguous: wrap early if the end gap is too small.
+        // At most one gap can exist at a time (the reader must consume it
+        // before the writer can reach the end again).
+        if (gap > 0) {
+            if (gap >= sizeof(uint32_t)) {
+                writeU32(head_, SKIP_MARKER);
+            }
+            skipBytes_ = gap;
+            used_     += gap;
+            head_      = 0;
+        }
+
+        writeU32(head_, static_cast<uint32_t>(len));
+        memcpy(buf_ + head_ + sizeof(uint32_t), batch, len);
+        head_ = (head_ + sizeof(uint32_t) + len) % cap_;
+        used_ += sizeof(uint32_t) + len;
+        stored_++;
+        return true;
+    }
+
+    /**
+     * @brief Oldest spilled batch, directly addressable in PSRAM.
+     * @return Pointer valid until the next popDiscard()/push(), or nullptr
+     *         when the ring is empty.
+     */
+    const BatchPacket* peek() {
+        skipIfMarker();
+        if (pendingBatches() == 0) return nullptr;
+        return reinterpret_cast<const BatchPacket*>(buf_ + tail_ + sizeof(uint32_t));
+    }
+
+    /** @brief Drop the oldest record (after a successful send, or to evict). */
+    bool popDiscard() {
+        skipIfMarker();
+        if (stored_ == drained_ + evictions_) return false;
+        uint32_t len = readU32(tail_);
+        tail_ = (tail_ + sizeof(uint32_t) + len) % cap_;
+        used_ -= sizeof(uint32_t) + len;
+        drained_++;
+        return true;
+    }
+
+    uint32_t pendingBatches() const { return stored_ - drained_ - evictions_; }
+    uint32_t evictions() const      { return evictions_; }
+
+private:
+    static constexpr uint32_t SKIP_MARKER = 0xFFFFFFFFu;
+
+    /** @brief Stored bytes for a batch: header + used frames only. */
+    static size_t recordLen(uint8_t nFrames) {
+        if (nFrames < 1 || nFrames > FRAMES_PER_BATCH_MAX) {
+            nFrames = FRAMES_PER_BATCH;
+        }
+        return sizeof(BatchHeader) + nFrames * sizeof(AudioFrame);
+    }
+
+    size_t freeBytes() const { return cap_ - used_; }
+
+    void skipIfMarker() {
+        if (used_ > 0 && (cap_ - tail_ < sizeof(uint32_t) ||
+                          readU32(tail_) == SKIP_MARKER)) {
+            used_ -= skipBytes_;
+            skipBytes_ = 0;
+            tail_ = 0;
+        }
+    }
+
+    void writeU32(size_t off, uint32_t v) { memcpy(buf_ + off, &v, sizeof(v)); }
+    uint32_t readU32(size_t off) const {
+        uint32_t v;
+        memcpy(&v, buf_ + off, sizeof(v));
+        return v;
+    }
+
+    uint8_t* buf_  = nullptr;
+    size_t   cap_  = 0;
+    size_t   head_ = 0;          ///< Write offset
+    size_t   tail_ = 0;          ///< Read offset
+    size_t   used_ = 0;          ///< Bytes occupied (records + skip gap)
+    size_t   skipBytes_ = 0;     ///< Bytes consumed by the current wrap gap
+    uint32_t stored_    = 0;
+    uint32_t drained_   = 0;
+    uint32_t evictions_ = 0;
+};
+
+#endif // SPILL_BUFFER_H
@@ -0,0 +1,168 @@
+/**
+ * @file telemetry.h
+ * @brief Counters plus cycle-accurate per-stage timing histograms.
+ *
+ * The original Telemetry struct only counted frames and overruns -- when a
+ * deadline was missed there was nothing to look at.  This adds log2-bucketed
+ * cycle histograms around the hot-path stages (capture read, inference,
+ * whole frame, WebSocket send) with a record() cost of a few instructions:
+ * one CLZ, one increment, two compares.  No floats, no locks, no
+ * allocation -- cheap enough to leave on in production.
+ *
+ * CONCURRENCY: each histogram is written by exactly one task (capture,
+ * processing, or sender) and only *read* by the stats reporter in loop().
+ * A reader may see a histogram mid-update; for 10-second telemetry
+ * snapshots that skew is irrelevant and not worth a lock on the hot path.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "protocol_schema.h"
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include "esp_cpu.h"
+/** @brief Current core's cycle counter (wraps every ~17.9 s at 240 MHz). */
+static inline uint32_t telemetryCycles() { return esp_cpu_get_cycle_count(); }
+#else
+#include "xtensa/hal.h"
+static inline uint32_t telemetryCycles() { return xthal_get_ccount(); }
+#endif
+
+/// CPU cycles per microsecond at the production clock (240 MHz, -O2 build)
+static constexpr uint32_t TELEMETRY_CYCLES_PER_US = 240;
+
+/**
+ * @struct CycleHist
+ * @brief Log2-bucketed histogram of cycle counts.
+ *
+ * Bucket i covers durations in [2^i, 2^(i+1)) cycles, so the full range
+ * (1 cycle .. ~70 ms) fits in 24 buckets and record() needs only a CLZ to
+ * find the bucket.  Percentiles read off the bucket boundaries -- accurate
+ * to a factor of 2, which is exactly the resolution needed to tell
+ * "RNNoise took 3 ms" from "the send stalled for 50 ms".
+ */
+struct CycleHist {
+    static constexpr int BUCKETS = 24;
+
+    uint32_t counts[BUCKETS] = {0};
+    uint32_t minCycles = 0;
+    uint32_t maxCycles = 0;
+    uint32_t samples   = 0;
+
+    /** @brief Record one duration.  Hot-path safe (no floats, no branches
+     *         beyond min/max updates). */
+    void record(uint32_t cycles) {
+        int bucket = 31 - __builtin_clz(cycles | 1);
+        if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+        counts[bucket]++;
+        if (samples == 0 || cycles < minCycles) minCycles = cycles;
+        if (cycles > maxCycles)                 maxCycles = cycles;
+        samples++;
+    }
+
+    /**
+     * @brief Approximate percentile (upper bucket boundary), in cycles.
+     * @param p  Percentile in [1, 100], e.g. 50 or 99.
+     */
+    uint32_t percentileCycles(uint8_t p) const {
+        if (samples == 0) return 0;
+        uint64_t target = (static_cast<uint64_t>(samples) * p + 99) / 100;
+        uint64_t seen   = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += counts[b];
+            if (seen >= target) {
+                return (b + 1 >= 32) ? UINT32_MAX : (1u << (b + 1));
+            }
+        }
+        return maxCycles;
+    }
+
+    /** @brief Percentile converted to microseconds for log lines. */
+    uint32_t percentileUs(uint8_t p) const {
+        return percentileCycles(p) / TELEMETRY_CYCLES_PER_US;
+    }
+
+    void reset() {
+        memset(counts, 0, sizeof(counts));
+        minCycles = maxCycles = samples = 0;
+    }
+};
+
+/** Stage indices for the histogram array / wire export. */
+enum TelemetryStage : uint8_t {
+    TSTAGE_CAPTURE_READ = 0,  ///< I2SDriver::readFrames() incl. conversion
+    TSTAGE_INFERENCE    = 1,  ///< processor processFrame()/processBatch()
+    TSTAGE_FRAME_TOTAL  = 2,  ///< AudioPipeline::processFrame() end to end
+    TSTAGE_WS_SEND      = 3,  ///< WebSocketManager::sendBatch() incl. encode
+    TSTAGE_COUNT        = 4
+};
+
+struct Telemetry {
+    uint32_t framesCaptured  = 0;
+    uint32_t framesProcessed = 0;
+    uint32_t batchesSent     = 0;
+    uint32_t batchesDropped  = 0;   ///< Drop-oldest evictions while WiFi stalls
+    uint32_t queueOverruns   = 0;
+    uint32_t dmaOverruns     = 0;   ///< I2S RX_Q_OVF events (late capture task)
+    uint32_t batchesSuppressed = 0; ///< Silence markers sent by the VAD gate
+                                    ///  (serial stats only, not on the wire)
+    uint32_t ringHighWater   = 0;   ///< Frame-ring watermark, sampled by the
+                                    ///  stats reporter each interval
+    uint32_t idleFrames      = 0;   ///< Frames drained-but-unpublished in
+                                    ///  low-power idle (serial stats only)
+    uint32_t gapEvents       = 0;   ///< Sequence discontinuities seen by the
+                                    ///  pipeline's continuity check
+    uint32_t gapFramesLost   = 0;   ///< Total frames missing across those
+                                    ///  gaps (includes deliberate idle gaps)
+    uint32_t fillerFrames    = 0;   ///< Zero-PCM fillers injected
+                                    ///  (Config::GAP_ZERO_FILL)
+
+    // Memory headroom, sampled by the stats reporter each interval (the
+    // heap walk is too expensive for a hot path, and once per 10 s is
+    // exactly the resolution a slow leak or a creeping stack needs).
+    // Stack figures are FreeRTOS high-watermarks: bytes of each task's
+    // stack that have NEVER been used -- the true overshoot of the
+    // Config::TASK_STACK_* guesses.
+    uint32_t heapFree     = 0;      ///< Free internal SRAM right now
+    uint32_t heapLargest  = 0;      ///< Largest contiguous free block
+    uint32_t heapMinFree  = 0;      ///< Lifetime low-water of free SRAM
+    uint32_t stackFree[3] = {0};    ///< Indexed as the wire packet's
+                                    ///  stack_free[] (capture/proc/sender)
+
+    CycleHist stages[TSTAGE_COUNT];
+
+    /** @brief Fill the wire export packet from the current histograms. */
+    void exportPacket(TelemetryPacket* pkt) const {
+        memset(pkt, 0, sizeof(*pkt));
+        pkt->magic           = PROTOCOL_MAGIC;
+        pkt->version         = PROTOCOL_VERSION_V2;
+        pkt->payload_mode    = WIRE_PAYLOAD_TELEMETRY;
+        pkt->stage_count     = TSTAGE_COUNT;
+        pkt->uptime_ms       = millis();
+        pkt->frames_captured  = framesCaptured;
+        pkt->frames_processed = framesProcessed;
+        pkt->batches_sent     = batchesSent;
+        pkt->batches_dropped  = batchesDropped;
+        pkt->queue_overruns   = queueOverruns;
+        pkt->dma_overruns     = dmaOverruns;
+        pkt->ring_high_water  = ringHighWater;
+        pkt->heap_free        = heapFree;
+        pkt->heap_largest     = heapLargest;
+        pkt->heap_min_free    = heapMinFree;
+        for (int t = 0; t < 3; t++) pkt->stack_free[t] = stackFree[t];
+        for (int s = 0; s < TSTAGE_COUNT; s++) {
+            pkt->stage[s].samples   = stages[s].samples;
+            pkt->stage[s].min_cyc   = stages[s].minCycles;
+            pkt->stage[s].max_cyc   = stages[s].maxCycles;
+            pkt->stage[s].p50_cyc   = stages[s].percentileCycles(50);
+            pkt->stage[s].p99_cyc   = stages[s].percentileCycles(99);
+        }
+    }
+};
+
+// Defined in main.cpp, shared by all tasks.
+extern Telemetry g_telemetry;
+
+#endif // TELEMETRY_H
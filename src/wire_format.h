@@ -0,0 +1,369 @@
+/**
+ * @file wire_format.h
+ * @brief Encodes assembled BatchPackets into the negotiated v2 wire image.
+ *
+ * The pipeline keeps assembling batches in the internal BatchPacket layout
+ * (raw + clean at full resolution -- processors write inference output
+ * straight into it).  This encoder runs on the sender task, just before
+ * transmission, so payload-mode trimming costs WiFi-side time rather than
+ * inference budget, and a mode change between batches simply changes how
+ * the next batch is serialized.
+ *
+ * Layouts and the delta-residual scheme are documented in protocol_schema.h.
+ */
+
+#ifndef WIRE_FORMAT_H
+#define WIRE_FORMAT_H
+
+#include <stddef.h>
+#include <string.h>
+#include "esp_rom_crc.h"       // ROM CRC32 (table in mask ROM, ~1 cyc/byte)
+#include "protocol_schema.h"
+
+/** @brief Encode one frame's raw PCM as the int8 residual stream
+ *         (WIRE_PAYLOAD_RAW_DELTA8 -- scheme in protocol_schema.h). */
+static inline void wireEncodeDelta8(const AudioFrame* frame, size_t nSamples,
+                                    int8_t* out) {
+    for (size_t i = 0; i < nSamples; i++) {
+        // Predict raw from clean via the inverse headroom scale, encode
+        // the shifted residual with saturation.
+        int32_t pred = (static_cast<int32_t>(frame->clean_pcm[i]) *
+                        WIRE_RAW_PRED_NUM) / WIRE_RAW_PRED_DEN;
+        int32_t res  = (static_cast<int32_t>(frame->raw_pcm[i]) - pred)
+                       >> WIRE_RAW_DELTA_SHIFT;
+        if (res >  127) res =  127;
+        if (res < -128) res = -128;
+        out[i] = static_cast<int8_t>(res);
+    }
+}
+
+/** @brief 8x peak-decimated raw preview (WIRE_PAYLOAD_RAW_PREVIEW8).
+ *
+ *  Each output sample is the largest-magnitude sample of its group with
+ *  the sign kept, so min/max waveform envelopes survive decimation --
+ *  plain subsampling would miss transient peaks between picks. */
+static inline void wireEncodePreview8(const AudioFrame* frame,
+                                      size_t nSamples, int16_t* out) {
+    for (size_t i = 0; i < nSamples; i += WIRE_PREVIEW_DECIM) {
+        int16_t peak = frame->raw_pcm[i];
+        int32_t mag  = (peak < 0) ? -static_cast<int32_t>(peak) : peak;
+        for (int j = 1; j < WIRE_PREVIEW_DECIM; j++) {
+            const int16_t s = frame->raw_pcm[i + j];
+            const int32_t m = (s < 0) ? -static_cast<int32_t>(s) : s;
+            if (m > mag) {
+                mag  = m;
+                peak = s;
+            }
+        }
+        *out++ = peak;
+    }
+}
+
+/**
+ * @brief Serialize one batch into a v2 wire message.
+ *
+ * The encoded payload is stamped with a CRC32 (payload_crc32) so the
+ * server can tell on-air/bridge corruption from ESP-side problems.  The
+ * CRC runs over the wire image -- it must cover the bytes that actually
+ * travel, which only exist here, after payload-mode trimming.
+ *
+ * @param batch    Fully assembled internal batch (header sealed).
+ * @param mode     WIRE_PAYLOAD_* negotiated for this connection.
+ * @param dropped  Frames lost on-ESP since the previous transmitted batch
+ *                 (already saturated to uint16 by the caller).
+ * @param out      Destination buffer, at least WIRE_BATCH_V2_MAX bytes.
+ * @param outCap   Capacity of `out`.
+ * @return         Encoded size in bytes, or 0 if `out` is too small /
+ *                 the mode is unknown.
+ */
+static size_t wireEncodeBatchV2(const BatchPacket* batch, uint8_t mode,
+                                uint16_t dropped,
+                                uint8_t* out, size_t outCap) {
+    // The pipeline stamps the rate code alongside the frame count when it
+    // seals the batch; in 16 kHz mode each frame carries 160 samples and
+    // every payload below shrinks 3x.
+    const uint8_t rateCode = batch->header.reserved[1];
+    const size_t  nSamples = WIRE_FRAME_SAMPLES(rateCode);
+    const size_t  pcmBytes = nSamples * sizeof(int16_t);
+
+    const size_t previewBytes =
+        (nSamples / WIRE_PREVIEW_DECIM) * sizeof(int16_t);
+
+    size_t perFrame;
+    switch (mode) {
+        case WIRE_PAYLOAD_FULL:         perFrame = 2 * pcmBytes;              break;
+        case WIRE_PAYLOAD_CLEAN_ONLY:   perFrame = pcmBytes;                  break;
+        case WIRE_PAYLOAD_RAW_DELTA8:   perFrame = pcmBytes + nSamples;       break;
+        case WIRE_PAYLOAD_RAW_PREVIEW8: perFrame = pcmBytes + previewBytes;   break;
+        default: return 0;
+    }
+
+    // The pipeline stamps the (runtime-selectable) frame count into the
+    // internal header when it seals the batch.
+    int nFrames = batch->header.reserved[0];
+    if (nFrames < 1 || nFrames > FRAMES_PER_BATCH_MAX) {
+        nFrames = FRAMES_PER_BATCH;
+    }
+
+    const size_t total = sizeof(BatchHeaderV2) +
+                         nFrames * (sizeof(FrameHeaderV2) + perFrame);
+    if (outCap < total) return 0;
+
+    uint8_t* p = out;
+
+    BatchHeaderV2 hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic            = PROTOCOL_MAGIC;
+    hdr.version          = PROTOCOL_VERSION_V2;
+    hdr.payload_mode     = mode;
+    hdr.frames_per_batch = static_cast<uint8_t>(nFrames);
+    hdr.sample_rate_code = rateCode;
+    hdr.batch_seq          = batch->header.batch_seq;
+    hdr.timestamp_ms       = batch->header.timestamp_ms;
+    hdr.dropped_since_last = dropped;
+    memcpy(p, &hdr, sizeof(hdr));
+    p += sizeof(hdr);
+
+    for (int f = 0; f < nFrames; f++) {
+        const AudioFrame* frame = &batch->frames[f];
+
+        FrameHeaderV2 fh;
+        memset(&fh, 0, sizeof(fh));
+        fh.frame_seq  = frame->frame_seq;
+        fh.vad_prob   = frame->vad_prob;
+        fh.rms_raw    = frame->rms_raw;
+        fh.channel    = frame->channel;
+        fh.flags      = frame->flags;
+        fh.gap_frames = frame->gap_frames;
+        memcpy(p, &fh, sizeof(fh));
+        p += sizeof(fh);
+
+        switch (mode) {
+            case WIRE_PAYLOAD_FULL:
+                memcpy(p, frame->raw_pcm, pcmBytes);
+                p += pcmBytes;
+                memcpy(p, frame->clean_pcm, pcmBytes);
+                p += pcmBytes;
+                break;
+
+            case WIRE_PAYLOAD_CLEAN_ONLY:
+                memcpy(p, frame->clean_pcm, pcmBytes);
+                p += pcmBytes;
+                break;
+
+            case WIRE_PAYLOAD_RAW_DELTA8:
+                memcpy(p, frame->clean_pcm, pcmBytes);
+                p += pcmBytes;
+                wireEncodeDelta8(frame, nSamples, reinterpret_cast<int8_t*>(p));
+                p += nSamples;
+                break;
+
+            case WIRE_PAYLOAD_RAW_PREVIEW8:
+                memcpy(p, frame->clean_pcm, pcmBytes);
+                p += pcmBytes;
+                wireEncodePreview8(frame, nSamples,
+                                   reinterpret_cast<int16_t*>(p));
+                p += previewBytes;
+                break;
+        }
+    }
+
+    // Stamp the payload CRC now that the wire image exists.  The ROM
+    // routine with init 0 matches Python's zlib.crc32 byte for byte.
+    const uint32_t crc = esp_rom_crc32_le(0, out + sizeof(BatchHeaderV2),
+                                          total - sizeof(BatchHeaderV2));
+    memcpy(out + offsetof(BatchHeaderV2, payload_crc32), &crc, sizeof(crc));
+
+    return total;
+}
+
+/* ---------------------------------------------------------------------------
+ * Scatter-gather encoding
+ *
+ * wireEncodeBatchV2() copies every payload byte into a contiguous staging
+ * buffer before the transport copies it again into the TCP stream.  The
+ * gather variant instead emits a segment list -- batch header, then per
+ * frame a FrameHeaderV2 plus pointers straight into the BatchPacket's pcm
+ * arrays -- that a fragmented-frame transport can walk with zero staging
+ * copies.  Byte-for-byte the wire image is identical to the contiguous
+ * encoder's, including the payload CRC (accumulated across segments up
+ * front, since the header travels first).
+ *
+ * Only RAW_DELTA8 still materializes bytes: the int8 residuals do not
+ * exist in the batch and are written into the caller's scratch (one
+ * nSamples run per frame, ~7.7 KB worst case vs. the ~31 KB staging
+ * buffer this path retires).
+ * ------------------------------------------------------------------------ */
+
+/** One contiguous span of an outgoing wire message. */
+typedef struct {
+    const uint8_t* data;
+    size_t         len;
+} WireSegment;
+
+/** Segment list for one batch: header + per frame (header + <=2 payloads). */
+typedef struct {
+    BatchHeaderV2 hdr;                            ///< Segment 0 points here
+    FrameHeaderV2 frameHdrs[FRAMES_PER_BATCH_MAX];
+    WireSegment   segs[1 + 3 * FRAMES_PER_BATCH_MAX];
+    int           nSegs;
+    size_t        totalBytes;                     ///< Sum of all segment lens
+} WireGather;
+
+/**
+ * @brief Build the segment list for one batch (no payload copies).
+ *
+ * @param batch         Fully assembled internal batch (header sealed).
+ * @param mode          WIRE_PAYLOAD_* negotiated for this connection.
+ * @param dropped       Frames lost on-ESP since the last transmitted batch.
+ * @param g             Descriptor to fill; must stay alive (and the batch
+ *                      unreleased) until the transport has consumed every
+ *                      segment.
+ * @param scratch       Store for payload bytes that do not exist in the
+ *                      batch (RAW_DELTA8 residuals, RAW_PREVIEW8 preview
+ *                      samples), at least FRAMES_PER_BATCH_MAX * FRAME_SIZE
+ *                      bytes; untouched in the other modes.
+ * @return              Total wire bytes described, or 0 on unknown mode.
+ */
+static size_t wireGatherBatchV2(const BatchPacket* batch, uint8_t mode,
+                                uint16_t dropped, WireGather* g,
+                                uint8_t* scratch) {
+    const uint8_t rateCode = batch->header.reserved[1];
+    const size_t  nSamples = WIRE_FRAME_SAMPLES(rateCode);
+    const size_t  pcmBytes = nSamples * sizeof(int16_t);
+
+    if (mode != WIRE_PAYLOAD_FULL && mode != WIRE_PAYLOAD_CLEAN_ONLY &&
+        mode != WIRE_PAYLOAD_RAW_DELTA8 && mode != WIRE_PAYLOAD_RAW_PREVIEW8) {
+        return 0;
+    }
+
+    int nFrames = batch->header.reserved[0];
+    if (nFrames < 1 || nFrames > FRAMES_PER_BATCH_MAX) {
+        nFrames = FRAMES_PER_BATCH;
+    }
+
+    memset(&g->hdr, 0, sizeof(g->hdr));
+    g->hdr.magic             = PROTOCOL_MAGIC;
+    g->hdr.version           = PROTOCOL_VERSION_V2;
+    g->hdr.payload_mode      = mode;
+    g->hdr.frames_per_batch  = static_cast<uint8_t>(nFrames);
+    g->hdr.sample_rate_code  = rateCode;
+    g->hdr.batch_seq         = batch->header.batch_seq;
+    g->hdr.timestamp_ms      = batch->header.timestamp_ms;
+    g->hdr.dropped_since_last = dropped;
+
+    int    n     = 0;
+    size_t total = sizeof(g->hdr);
+    g->segs[n].data = reinterpret_cast<const uint8_t*>(&g->hdr);
+    g->segs[n].len  = sizeof(g->hdr);
+    n++;
+
+    for (int f = 0; f < nFrames; f++) {
+        const AudioFrame* frame = &batch->frames[f];
+
+        FrameHeaderV2* fh = &g->frameHdrs[f];
+        memset(fh, 0, sizeof(*fh));
+        fh->frame_seq  = frame->frame_seq;
+        fh->vad_prob   = frame->vad_prob;
+        fh->rms_raw    = frame->rms_raw;
+        fh->channel    = frame->channel;
+        fh->flags      = frame->flags;
+        fh->gap_frames = frame->gap_frames;
+        g->segs[n].data = reinterpret_cast<const uint8_t*>(fh);
+        g->segs[n].len  = sizeof(*fh);
+        n++;
+
+        switch (mode) {
+            case WIRE_PAYLOAD_FULL:
+                g->segs[n].data = reinterpret_cast<const uint8_t*>(frame->raw_pcm);
+                g->segs[n].len  = pcmBytes;
+                n++;
+                g->segs[n].data = reinterpret_cast<const uint8_t*>(frame->clean_pcm);
+                g->segs[n].len  = pcmBytes;
+                n++;
+                break;
+
+            case WIRE_PAYLOAD_CLEAN_ONLY:
+                g->segs[n].data = reinterpret_cast<const uint8_t*>(frame->clean_pcm);
+                g->segs[n].len  = pcmBytes;
+                n++;
+                break;
+
+            case WIRE_PAYLOAD_RAW_DELTA8: {
+                g->segs[n].data = reinterpret_cast<const uint8_t*>(frame->clean_pcm);
+                g->segs[n].len  = pcmBytes;
+                n++;
+                int8_t* delta = reinterpret_cast<int8_t*>(scratch) + f * nSamples;
+                wireEncodeDelta8(frame, nSamples, delta);
+                g->segs[n].data = reinterpret_cast<const uint8_t*>(delta);
+                g->segs[n].len  = nSamples;
+                n++;
+                break;
+            }
+
+            case WIRE_PAYLOAD_RAW_PREVIEW8: {
+                g->segs[n].data = reinterpret_cast<const uint8_t*>(frame->clean_pcm);
+                g->segs[n].len  = pcmBytes;
+                n++;
+                const size_t previewBytes =
+                    (nSamples / WIRE_PREVIEW_DECIM) * sizeof(int16_t);
+                int16_t* preview = reinterpret_cast<int16_t*>(
+                    scratch + f * previewBytes);
+                wireEncodePreview8(frame, nSamples, preview);
+                g->segs[n].data = reinterpret_cast<const uint8_t*>(preview);
+                g->segs[n].len  = previewBytes;
+                n++;
+                break;
+            }
+        }
+    }
+
+    // The header travels first, so the payload CRC is accumulated over
+    // the segments before anything is sent.  Chained calls with the
+    // previous result as init match zlib.crc32 exactly.
+    uint32_t crc = 0;
+    for (int i = 1; i < n; i++) {
+        crc = esp_rom_crc32_le(crc, g->segs[i].data, g->segs[i].len);
+        total += g->segs[i].len;
+    }
+    g->hdr.payload_crc32 = crc;
+
+    g->nSegs      = n;
+    g->totalBytes = total;
+    return total;
+}
+
+/**
+ * @brief Serialize a header-only silence marker for a suppressed batch.
+ *
+ * Carries the same sequencing/rate metadata as the full encoding would,
+ * so the client's timeline accounting is unaffected by suppression.
+ *
+ * @param batch   The (all-silent) batch being suppressed.
+ * @param out     Destination buffer, at least sizeof(BatchHeaderV2) bytes.
+ * @param outCap  Capacity of `out`.
+ * @return        Encoded size (sizeof(BatchHeaderV2)), or 0 if too small.
+ */
+static size_t wireEncodeSilenceV2(const BatchPacket* batch,
+                                  uint8_t* out, size_t outCap) {
+    if (outCap < sizeof(BatchHeaderV2)) return 0;
+
+    int nFrames = batch->header.reserved[0];
+    if (nFrames < 1 || nFrames > FRAMES_PER_BATCH_MAX) {
+        nFrames = FRAMES_PER_BATCH;
+    }
+
+    BatchHeaderV2 hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic            = PROTOCOL_MAGIC;
+    hdr.version          = PROTOCOL_VERSION_V2;
+    hdr.payload_mode     = WIRE_PAYLOAD_SILENCE;
+    hdr.frames_per_batch = static_cast<uint8_t>(nFrames);
+    hdr.sample_rate_code = batch->header.reserved[1];
+    hdr.batch_seq        = batch->header.batch_seq;
+    hdr.timestamp_ms     = batch->header.timestamp_ms;
+    memcpy(out, &hdr, sizeof(hdr));
+    return sizeof(hdr);
+}
+
+#endif // WIRE_FORMAT_H
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""
+Export a WAV recording to the flash-embedded replay clip header the
+firmware compiles in (src/replay_clip.h, consumed by src/replay.h).
+
+The replay harness pushes this clip through the live AudioPipeline at
+boot and prints a chained CRC32 of everything that comes out -- so the
+clip IS the regression baseline: keep the same file checked into your
+test assets and the checksum is comparable across firmware versions.
+
+Input requirements (the script refuses anything else rather than
+resampling badly):
+
+    16-bit PCM WAV, mono, 48 kHz
+
+Pick a clip with both speech and silence so the VAD, RMS, and gate
+paths all see realistic input.  A few seconds is plenty; every second
+costs ~94 KB of flash.
+
+Usage:
+    python3 tools/export_replay_clip.py clip.wav src/replay_clip.h
+"""
+
+import struct
+import sys
+import wave
+
+EXPECTED_RATE = 48000
+SAMPLES_PER_LINE = 12
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    wav_path, out_path = sys.argv[1], sys.argv[2]
+
+    with wave.open(wav_path, "rb") as w:
+        if w.getnchannels() != 1:
+            sys.exit(f"ERROR: {wav_path} has {w.getnchannels()} channels; "
+                     "the replay clip must be mono")
+        if w.getsampwidth() != 2:
+            sys.exit(f"ERROR: {wav_path} is {8 * w.getsampwidth()}-bit; "
+                     "the replay clip must be 16-bit PCM")
+        if w.getframerate() != EXPECTED_RATE:
+            sys.exit(f"ERROR: {wav_path} is {w.getframerate()} Hz; "
+                     f"the replay clip must be {EXPECTED_RATE} Hz "
+                     "(resample it first, e.g. with sox)")
+        n = w.getnframes()
+        samples = struct.unpack(f"<{n}h", w.readframes(n))
+
+    print(f"{wav_path}: {n} samples ({n / EXPECTED_RATE:.2f} s, "
+          f"{2 * n / 1024:.0f} KB of flash)")
+
+    with open(out_path, "w") as f:
+        f.write("// Generated by tools/export_replay_clip.py -- do not edit.\n")
+        f.write(f"// Source: {wav_path} ({n / EXPECTED_RATE:.2f} s mono "
+                f"{EXPECTED_RATE} Hz)\n")
+        f.write("#ifndef REPLAY_CLIP_H\n#define REPLAY_CLIP_H\n\n")
+        f.write("#include <stdint.h>\n\n")
+        f.write(f"#define REPLAY_CLIP_SAMPLES {n}\n\n")
+        f.write("const int16_t REPLAY_CLIP_PCM[REPLAY_CLIP_SAMPLES] = {\n")
+        for i in range(0, n, SAMPLES_PER_LINE):
+            row = samples[i:i + SAMPLES_PER_LINE]
+            f.write("    " + ", ".join(str(s) for s in row) + ",\n")
+        f.write("};\n\n#endif // REPLAY_CLIP_H\n")
+
+    print(f"wrote {out_path}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""
+Export a trained RNNoise-style model to the quantized flash header the
+firmware compiles in (src/rnnoise_weights.h, consumed by
+src/rnnoise_processor.h).
+
+Input is an .npz with one array per layer, Keras orientation (kernels are
+[in_dim, out_dim]; this script transposes to the firmware's row-per-output
+layout).  Expected names and shapes, with F = input features (44),
+D = dense units, G = GRU units, B = bands (22):
+
+    input_w  [F, D]   input_b  [D]        dense tanh layer
+    gru_wz   [D, G]   gru_uz   [G, G]     gru_bz [G]     update gate
+    gru_wr   [D, G]   gru_ur   [G, G]     gru_br [G]     reset gate
+    gru_wh   [D, G]   gru_uh   [G, G]     gru_bh [G]     candidate
+    gains_w  [G, B]   gains_b  [B]        sigmoid band-gain head
+    vad_w    [G]      vad_b    []         sigmoid VAD head
+
+Quantization matches the firmware's fixed-point conventions exactly
+(see rnn_detail in rnnoise_processor.h):
+
+    weights: int8, scale 1/64  -> representable range [-2.0, +1.984]
+    biases:  int32, Q12        -> added to the pre-activation directly
+
+Train with a weight-clamp (or weight-decay) keeping kernels inside
+[-2, 2); anything outside saturates here and the script warns about it.
+
+Usage:
+    python3 tools/export_rnnoise_weights.py model.npz src/rnnoise_weights.h
+"""
+
+import sys
+
+import numpy as np
+
+WEIGHT_SCALE = 64       # int8 weight = round(w * 64)
+BIAS_SCALE = 4096       # int32 bias   = round(b * 4096)  (Q12)
+
+# (name, expects_transpose) -- kernels come in Keras [in, out] orientation,
+# the firmware wants row-per-output-unit.
+KERNELS = [
+    "input_w",
+    "gru_wz", "gru_wr", "gru_wh",
+    "gru_uz", "gru_ur", "gru_uh",
+    "gains_w",
+]
+BIASES = [
+    "input_b",
+    "gru_bz", "gru_br", "gru_bh",
+    "gains_b",
+    "vad_b",
+]
+
+
+def quantize_weights(name, arr):
+    """int8 weights, scale 1/64, warn on saturation."""
+    q = np.round(arr * WEIGHT_SCALE)
+    clipped = np.count_nonzero((q < -128) | (q > 127))
+    if clipped:
+        print(f"  WARNING: {name}: {clipped}/{q.size} weights saturate "
+              f"[-2, 2) -- retrain with a weight clamp", file=sys.stderr)
+    return np.clip(q, -128, 127).astype(np.int8)
+
+
+def quantize_biases(name, arr):
+    """int32 biases in Q12."""
+    return np.round(np.atleast_1d(arr) * BIAS_SCALE).astype(np.int32)
+
+
+def emit_array(out, ctype, name, values, per_line=12):
+    flat = values.ravel()
+    out.write(f"alignas(4) const {ctype} {name}[{flat.size}] = {{\n")
+    for i in range(0, flat.size, per_line):
+        row = ", ".join(str(v) for v in flat[i:i + per_line])
+        out.write(f"    {row},\n")
+    out.write("};\n\n")
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__, file=sys.stderr)
+        return 1
+    model_path, header_path = sys.argv[1], sys.argv[2]
+    model = np.load(model_path)
+
+    n_feat, n_dense = model["input_w"].shape
+    n_gru = model["gru_uz"].shape[0]
+    n_bands = model["gains_w"].shape[1]
+    print(f"Model: {n_feat} features -> dense {n_dense} -> GRU {n_gru} "
+          f"-> {n_bands} bands + VAD")
+
+    total = 0
+    with open(header_path, "w") as out:
+        out.write(
+            "// Generated by tools/export_rnnoise_weights.py -- do not edit.\n"
+            f"// Source model: {model_path}\n"
+            "// Weights int8 (scale 1/64), biases int32 (Q12); layout is\n"
+            "// row-per-output-unit as indexed by rnnoise_processor.h.\n\n"
+            "#ifndef RNNOISE_WEIGHTS_H\n"
+            "#define RNNOISE_WEIGHTS_H\n\n"
+            "#include <stdint.h>\n\n"
+            "#define RNN_WEIGHTS_VERSION 1\n\n"
+            f"constexpr int RNN_NB_FEATURES = {n_feat};\n"
+            f"constexpr int RNN_DENSE_UNITS = {n_dense};\n"
+            f"constexpr int RNN_GRU_UNITS   = {n_gru};\n"
+            f"constexpr int RNN_NB_BANDS    = {n_bands};\n\n")
+        for name in KERNELS:
+            q = quantize_weights(name, model[name].T)  # -> [out, in]
+            emit_array(out, "int8_t", f"rnn_{name}", q)
+            total += q.size
+        for name in BIASES:
+            emit_array(out, "int32_t", f"rnn_{name}",
+                       quantize_biases(name, model[name]), per_line=8)
+        # VAD kernel is a vector; no transpose needed.
+        q = quantize_weights("vad_w", model["vad_w"])
+        emit_array(out, "int8_t", "rnn_vad_w", q)
+        total += q.size
+        out.write("#endif // RNNOISE_WEIGHTS_H\n")
+
+    print(f"Wrote {header_path}: {total} int8 weights "
+          f"(~{total / 1024:.1f} KB flash)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())